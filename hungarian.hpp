@@ -0,0 +1,4771 @@
+/* This is an implementation of the Hungarian algorithm in C++
+ * The Hungarian algorithm, also know as Munkres or Kuhn-Munkres
+ * algorithm is usefull for solving the assignment problem.
+ *
+ * Assignment problem: Let C be an n x n matrix 
+ * representing the costs of each of n workers to perform any of n jobs.
+ * The assignment problem is to assign jobs to workers so as to 
+ * minimize the total cost. Since each worker can perform only one job and 
+ * each job can be assigned to only one worker the assignments constitute 
+ * an independent set of the matrix C.
+ * 
+ * It is a port heavily based on http://csclab.murraystate.edu/~bob.pilgrim/445/munkres.html
+ * 
+ * This version is written by Fernando B. Giannasi */
+
+#ifndef MUNKRES_HUNGARIAN_HPP
+#define MUNKRES_HUNGARIAN_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(MUNKRES_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define MUNKRES_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/* Build with -DMUNKRES_STATS to record a SolveStats for every solve.  Without it every
+ * MUNKRES_STAT() statement is compiled out and the stats stay zero. */
+#ifdef MUNKRES_STATS
+#define MUNKRES_STAT(...) __VA_ARGS__
+#if defined(MUNKRES_X86_SIMD)
+#include <x86intrin.h>
+#endif
+#else
+#define MUNKRES_STAT(...)
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MUNKRES_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace Munkres {
+    
+/* Utility function to print Matrix */
+template<template <typename, typename...> class Container,
+                   typename T,
+                   typename... Args>
+//disable for string, which is std::basic_string<char>, a container itself
+typename std::enable_if<!std::is_convertible<Container<T, Args...>, std::string>::value &&
+                        !std::is_constructible<Container<T, Args...>, std::string>::value,
+                            std::ostream&>::type
+operator<<(std::ostream& os, const Container<T, Args...>& con)
+{
+    os << " ";
+    for (auto& elem: con)
+        os << elem << " ";
+
+    os << "\n";
+    return os;
+}
+
+/* Minimal allocator returning Align-byte aligned blocks. The offset to the block
+ * returned by operator new is stored just before the aligned pointer. */
+template<typename T, std::size_t Align = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Align>; };
+    
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+    
+    T* allocate(std::size_t n)
+    {
+        if (n > (std::numeric_limits<std::size_t>::max() - Align) / sizeof(T))
+            throw std::bad_alloc();
+        
+        char* raw = static_cast<char*>(::operator new(n * sizeof(T) + Align));
+        std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(raw) + Align;
+        char* aligned = reinterpret_cast<char*>(addr & ~(std::uintptr_t(Align) - 1));
+        reinterpret_cast<unsigned char*>(aligned)[-1] = 
+            static_cast<unsigned char>(aligned - raw - 1);
+        return reinterpret_cast<T*>(aligned);
+    }
+    
+    void deallocate(T* p, std::size_t)
+    {
+        unsigned char* aligned = reinterpret_cast<unsigned char*>(p);
+        ::operator delete(aligned - aligned[-1] - 1);
+    }
+};
+
+template<typename T, typename U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) {return true;}
+
+template<typename T, typename U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) {return false;}
+
+/* Dense row-major matrix living in a single aligned allocation. Every row is padded
+ * to a whole number of cache lines (the stride), so rows start aligned and column
+ * walks stay within one block of memory. matrix[r][c] works as with nested vectors. */
+template<typename T>
+class Matrix {
+public:
+    Matrix() = default;
+    
+    Matrix(std::size_t rows, std::size_t cols, const T& value = T())
+        : rows_ {rows}, cols_ {cols}, stride_ {round_stride(cols)},
+          data_ (rows * stride_, value) {}
+    
+    T* operator[](std::size_t r) {return data_.data() + r * stride_;}
+    const T* operator[](std::size_t r) const {return data_.data() + r * stride_;}
+    
+    std::size_t rows() const {return rows_;}
+    std::size_t cols() const {return cols_;}
+    std::size_t stride() const {return stride_;}
+    
+    T* data() {return data_.data();}
+    const T* data() const {return data_.data();}
+    
+    void fill(const T& value) {std::fill(data_.begin(), data_.end(), value);}
+    
+    /* New dimensions, every cell set to value. Reuses the allocation when it is big enough */
+    void assign(std::size_t rows, std::size_t cols, const T& value = T())
+    {
+        rows_ = rows;
+        cols_ = cols;
+        stride_ = round_stride(cols);
+        data_.assign(rows * stride_, value);
+    }
+    
+    /* Change dimensions keeping the top-left block, new cells get value */
+    void resize(std::size_t rows, std::size_t cols, const T& value = T())
+    {
+        if (round_stride(cols) == stride_) {
+            for (std::size_t r=0; r<std::min(rows, rows_); ++r)
+                std::fill(operator[](r) + std::min(cols, cols_), operator[](r) + cols, value);
+            data_.resize(rows * stride_, value);
+        }
+        else {
+            Matrix tmp (rows, cols, value);
+            for (std::size_t r=0; r<std::min(rows, rows_); ++r)
+                std::copy(operator[](r), operator[](r) + std::min(cols, cols_), tmp[r]);
+            swap(tmp);
+        }
+        rows_ = rows;
+        cols_ = cols;
+    }
+    
+    void swap(Matrix& other)
+    {
+        std::swap(rows_, other.rows_);
+        std::swap(cols_, other.cols_);
+        std::swap(stride_, other.stride_);
+        data_.swap(other.data_);
+    }
+    
+private:
+    static std::size_t round_stride(std::size_t cols)
+    {
+        const std::size_t line = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+        return (cols + line - 1) / line * line;
+    }
+    
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::size_t stride_ = 0;
+    std::vector<T, AlignedAllocator<T>> data_;
+};
+
+/* Read-only view of a row-major matrix owned by somebody else, e.g. a Matrix or an 
+ * mmapped buffer: row r starts at data + r*stride.  The solvers read their costs 
+ * through a view, so a problem given as one is solved without copying it. */
+template<typename T>
+class MatrixView {
+public:
+    MatrixView() = default;
+    
+    MatrixView(const T* data, std::size_t rows, std::size_t cols, std::size_t stride)
+        : data_ {data}, rows_ {rows}, cols_ {cols}, stride_ {stride} {}
+    
+    MatrixView(const T* data, std::size_t rows, std::size_t cols)
+        : MatrixView(data, rows, cols, cols) {}
+    
+    MatrixView(const Matrix<T>& matrix)
+        : MatrixView(matrix.data(), matrix.rows(), matrix.cols(), matrix.stride()) {}
+    
+    const T* operator[](std::size_t r) const {return data_ + r * stride_;}
+    
+    std::size_t rows() const {return rows_;}
+    std::size_t cols() const {return cols_;}
+    std::size_t stride() const {return stride_;}
+    const T* data() const {return data_;}
+    
+private:
+    const T* data_ = nullptr;
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::size_t stride_ = 0;
+};
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const Matrix<T>& mat)
+{
+    for (std::size_t r=0; r<mat.rows(); ++r) {
+        os << " ";
+        for (std::size_t c=0; c<mat.cols(); ++c)
+            os << +mat[r][c] << " "; // int8_t prints as a number, not a char
+        os << "\n";
+    }
+    return os;
+}
+
+/* Fixed set of worker threads used to split the O(n^2) scans of the solver. The calling
+ * thread always takes part, so a pool of size N starts N-1 workers. Loops with less 
+ * than serial_threshold elements of work run serially to avoid the wake-up cost. */
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency(),
+                        std::size_t serial_threshold = 1 << 15)
+        : threshold_ {serial_threshold}
+    {
+        for (std::size_t i=1; i<threads; ++i)
+            workers_.emplace_back([this, i]{work(i);});
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t: workers_)
+            t.join();
+    }
+    
+    std::size_t size() const {return workers_.size() + 1;}
+    std::size_t threshold() const {return threshold_;}
+    
+    /* Split [0, n) in size() contiguous chunks and call fn(begin, end) for each one,
+     * returning when all of them are done. Callers are serialized. */
+    template<typename F>
+    void run(std::size_t n, F& fn)
+    {
+        std::lock_guard<std::mutex> caller (run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            task_ = &fn;
+            invoke_ = [](void* f, std::size_t b, std::size_t e) {(*static_cast<F*>(f))(b, e);};
+            count_ = n;
+            pending_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        
+        invoke_(task_, 0, n / size()); // our own chunk
+        
+        std::unique_lock<std::mutex> lock (mutex_);
+        done_.wait(lock, [this]{return pending_ == 0;});
+    }
+    
+private:
+    void work(std::size_t chunk)
+    {
+        std::size_t seen = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock (mutex_);
+            wake_.wait(lock, [this, seen]{return stop_ || generation_ != seen;});
+            if (stop_)
+                return;
+            seen = generation_;
+            std::size_t b = count_ * chunk / size();
+            std::size_t e = count_ * (chunk + 1) / size();
+            lock.unlock();
+            
+            invoke_(task_, b, e);
+            
+            lock.lock();
+            if (--pending_ == 0)
+                done_.notify_one();
+        }
+    }
+    
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::mutex run_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    void* task_ = nullptr;
+    void (*invoke_)(void*, std::size_t, std::size_t) = nullptr;
+    std::size_t count_ = 0;
+    std::size_t pending_ = 0;
+    std::size_t generation_ = 0;
+    std::size_t threshold_;
+    bool stop_ = false;
+};
+
+/* Run fn(begin, end) over [0, n), on the pool when there is one and the loop does at
+ * least pool->threshold() elements of work, serially otherwise */
+template<typename F>
+void parallel_for(ThreadPool* pool, 
+                  std::size_t n, 
+                  std::size_t work, 
+                  F fn)
+{
+    if (pool == nullptr || pool->size() == 1 || work < pool->threshold())
+        fn(std::size_t(0), n);
+    else
+        pool->run(n, fn);
+}
+
+/* Bounded multi-producer multi-consumer queue (Vyukov).  push() and pop() never lock:
+ * each cell carries a sequence number telling whether it is free for the producer of
+ * that lap or holds a value for its consumer, and producers and consumers each claim
+ * cells by a compare-exchange on their own counter.  push() returns false when the
+ * queue is full, pop() when it is empty. */
+template<typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity)
+            size *= 2;
+        cells_.reset(new Cell[size]);
+        mask_ = size - 1;
+        for (std::size_t i=0; i<size; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+    
+    bool push(const T& value)
+    {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto lap = static_cast<std::ptrdiff_t>(seq - pos);
+            if (lap == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lap < 0)
+                return false; // the consumer of the previous lap has not taken it yet
+            else
+                pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+    
+    bool pop(T& value)
+    {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto lap = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (lap == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lap < 0)
+                return false;
+            else
+                pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+    
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+    
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_ = 0;
+    char pad0_[64]; // keep producers and consumers on their own cache lines
+    std::atomic<std::size_t> tail_ {0};
+    char pad1_[64];
+    std::atomic<std::size_t> head_ {0};
+};
+
+inline int ctz64(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int n = 0;
+    for (; !(word & 1); word >>= 1) ++n;
+    return n;
+#endif
+}
+
+inline int popcount64(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int n = 0;
+    for (; word; word &= word - 1) ++n;
+    return n;
+#endif
+}
+
+/* Covered rows or cols, one bit per line packed in 64-bit words.  Clearing is a memset,
+ * counting a popcount per word, and the uncovered lines are walked with ctz, a whole 
+ * word of covered lines being skipped at once.  Bits past size() stay zero. */
+class CoverSet {
+public:
+    void assign(std::size_t n)
+    {
+        size_ = n;
+        words_.assign((n + 63) / 64, 0);
+    }
+    
+    std::size_t size() const {return size_;}
+    const std::uint64_t* data() const {return words_.data();}
+    std::size_t capacity_bytes() const {return words_.capacity() * sizeof(std::uint64_t);}
+    
+    bool operator[](std::size_t i) const {return (words_[i >> 6] >> (i & 63)) & 1;}
+    void set(std::size_t i) {words_[i >> 6] |= std::uint64_t(1) << (i & 63);}
+    void reset(std::size_t i) {words_[i >> 6] &= ~(std::uint64_t(1) << (i & 63));}
+    
+    void clear()
+    {
+        if (!words_.empty())
+            std::memset(words_.data(), 0, words_.size() * sizeof(std::uint64_t));
+    }
+    
+    std::size_t count() const
+    {
+        std::size_t n = 0;
+        for (auto word: words_)
+            n += popcount64(word);
+        return n;
+    }
+    
+    // f(i) for every uncovered i in [b, e), in increasing order
+    template<typename F>
+    void for_each_clear(std::size_t b, std::size_t e, F f) const
+    {
+        if (b >= e)
+            return;
+        
+        for (std::size_t w = b >> 6; w <= (e - 1) >> 6; ++w) {
+            std::uint64_t open = ~words_[w];
+            if (w == b >> 6)
+                open &= ~std::uint64_t(0) << (b & 63);
+            if (w == (e - 1) >> 6 && (e & 63))
+                open &= ~(~std::uint64_t(0) << (e & 63));
+            
+            for (; open; open &= open - 1)
+                f(w * 64 + ctz64(open));
+        }
+    }
+    
+    template<typename F>
+    void for_each_clear(F f) const {for_each_clear(0, size_, f);}
+    
+private:
+    std::size_t size_ = 0;
+    std::vector<std::uint64_t> words_;
+};
+
+/* Cost of a forbidden pair: infinity for floating point costs, the largest value of
+ * integral ones.  The engines skip these cells, so they are never assigned and never
+ * enter the offset arithmetic, where they would overflow. */
+template<typename T>
+constexpr T forbidden()
+{
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                : std::numeric_limits<T>::max();
+}
+
+template<typename T>
+constexpr bool is_forbidden(T c)
+{
+    return c == forbidden<T>();
+}
+
+/* Type the cost of a solution is summed in: 64 bits for integral costs and at least 
+ * double for floating point ones, so the costs themselves can stay in a narrow type */
+template<typename T, bool = std::is_floating_point<T>::value>
+struct accumulator {
+    using type = typename std::conditional<std::is_signed<T>::value, std::int64_t, std::uint64_t>::type;
+};
+
+template<typename T>
+struct accumulator<T, true> {
+    using type = typename std::conditional<(sizeof(T) < sizeof(double)), double, T>::type;
+};
+
+/* SIMD kernels for the O(n^2) scans of the solver: the minimum of a row, the running
+ * minimum of a row into the column offsets, and the smallest reduced cost of a row over
+ * the uncovered columns (with its column), where the bits of the cover set are the lane
+ * mask.  Forbidden cells are left out of all three.
+ * The offsets have the potential type of the costs: float and double as they are, using
+ * SSE2, AVX2 or AVX-512 for float and AVX2 or AVX-512 for double, and int64_t for every
+ * integral type, whose costs of up to 64 bits are sign or zero extended into the 64 bit
+ * lanes of AVX2 or AVX-512.  The row minimum stays in the cost type, int32/float also 
+ * with SSE2.  The kernel is picked at runtime from the CPU.  Other types, and builds with
+ * MUNKRES_NO_SIMD, use the scalar loops. */
+namespace simd {
+
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+inline Isa detect_isa()
+{
+#ifdef MUNKRES_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return Isa::SSE2;
+#endif
+    return Isa::Scalar;
+}
+
+/* best instruction set of this CPU, detected once */
+inline Isa isa()
+{
+    static const Isa best = detect_isa();
+    return best;
+}
+
+// Portable versions, also used for the tails of the vector loops
+template<typename T>
+T row_min_scalar(const T* row, std::size_t n)
+{
+    T minval = forbidden<T>();
+    for (std::size_t c=0; c<n; ++c)
+        minval = std::min(minval, row[c]);
+    return minval;
+}
+
+template<typename T, typename P>
+void min_update_scalar(P* v, const T* row, P ui, std::size_t n)
+{
+    for (std::size_t c=0; c<n; ++c)
+        if (!is_forbidden(row[c]))
+            v[c] = std::min(v[c], static_cast<P>(static_cast<P>(row[c]) - ui));
+}
+
+/* Columns first to n-1, cover holding one bit per column from column 0 */
+template<typename T, typename P>
+P reduced_argmin_scalar(const T* row, const P* v, P ui, const std::uint64_t* cover, 
+                        std::size_t first, std::size_t n, int& col)
+{
+    P minval = std::numeric_limits<P>::max();
+    col = -1;
+    for (std::size_t w = first >> 6; w * 64 < n; ++w) {
+        std::uint64_t open = ~cover[w];
+        if (w == first >> 6)
+            open &= ~std::uint64_t(0) << (first & 63);
+        
+        for (; open; open &= open - 1) {
+            std::size_t c = w * 64 + ctz64(open);
+            if (c >= n)
+                break;
+            if (is_forbidden(row[c]))
+                continue;
+            P val = static_cast<P>(row[c]) - ui - v[c];
+            if (col == -1 || val < minval) {
+                minval = val;
+                col = c;
+            }
+        }
+    }
+    return minval;
+}
+
+template<typename T, typename P>
+P reduced_argmin_scalar(const T* row, const P* v, P ui, const std::uint64_t* cover, std::size_t n, int& col)
+{
+    return reduced_argmin_scalar(row, v, ui, cover, 0, n, col);
+}
+
+/* The cover bits of lanes columns from c, a multiple of lanes, which divides 64 */
+inline std::uint64_t cover_bits(const std::uint64_t* cover, std::size_t c, int lanes)
+{
+    return (cover[c >> 6] >> (c & 63)) & ((std::uint64_t(1) << lanes) - 1);
+}
+
+/* Merge the lanes of a vector argmin (-1 index for lanes that saw no uncovered column)
+ * with the scalar tail */
+template<typename T, typename I>
+T merge_argmin(const T* vals, const I* idx, int lanes,
+               T tail_val, int tail_col, int& col)
+{
+    T minval = std::numeric_limits<T>::max();
+    col = -1;
+    for (int l=0; l<lanes; ++l)
+        if (idx[l] != -1 && (col == -1 || vals[l] < minval || (vals[l] == minval && idx[l] < col))) {
+            minval = vals[l];
+            col = static_cast<int>(idx[l]);
+        }
+    if (tail_col != -1 && (col == -1 || tail_val < minval)) {
+        minval = tail_val;
+        col = tail_col;
+    }
+    return minval;
+}
+
+#ifdef MUNKRES_X86_SIMD
+
+#define MUNKRES_SSE2 __attribute__((target("sse2")))
+#define MUNKRES_AVX2 __attribute__((target("avx2")))
+#define MUNKRES_AVX512 __attribute__((target("avx512f")))
+
+// SSE2: no 32-bit min or blend, so both are built from compare and bit masks.  It has no
+// 64 bit compare either, so integral offsets take the scalar loops.
+
+MUNKRES_SSE2 inline __m128i select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/* 4 cover bits widened to a lane mask, all ones where uncovered */
+MUNKRES_SSE2 inline __m128i open_sse2(std::uint64_t bits)
+{
+    __m128i lane = _mm_setr_epi32(1, 2, 4, 8);
+    return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(bits)), lane), _mm_setzero_si128());
+}
+
+MUNKRES_SSE2 inline int32_t hmin_sse2(__m128i acc)
+{
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+}
+
+MUNKRES_SSE2 inline float hmin_sse2(__m128 acc)
+{
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    return std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+}
+
+MUNKRES_SSE2 inline int32_t row_min_sse2(const int32_t* row, std::size_t n)
+{
+    __m128i acc = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4) {
+        __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + c));
+        acc = select_sse2(_mm_cmpgt_epi32(acc, val), val, acc);
+    }
+    return std::min(hmin_sse2(acc), row_min_scalar(row + c, n - c));
+}
+
+MUNKRES_SSE2 inline float row_min_sse2(const float* row, std::size_t n)
+{
+    __m128 acc = _mm_set1_ps(forbidden<float>());
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4)
+        acc = _mm_min_ps(acc, _mm_loadu_ps(row + c));
+    return std::min(hmin_sse2(acc), row_min_scalar(row + c, n - c));
+}
+
+MUNKRES_SSE2 inline void min_update_sse2(float* v, const float* row, float ui, std::size_t n)
+{
+    const __m128 vu = _mm_set1_ps(ui);
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4)
+        _mm_storeu_ps(v + c, _mm_min_ps(_mm_loadu_ps(v + c), _mm_sub_ps(_mm_loadu_ps(row + c), vu)));
+    min_update_scalar(v + c, row + c, ui, n - c);
+}
+
+MUNKRES_SSE2 inline float reduced_argmin_sse2(const float* row, const float* v, float ui,
+                                              const std::uint64_t* cover, std::size_t n, int& col)
+{
+    const __m128 vu = _mm_set1_ps(ui);
+    const __m128i none = _mm_set1_epi32(-1);
+    const __m128 off = _mm_set1_ps(forbidden<float>());
+    __m128 acc = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128i best = none;
+    __m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4) {
+        __m128 cost = _mm_loadu_ps(row + c);
+        __m128 val = _mm_sub_ps(_mm_sub_ps(cost, vu), _mm_loadu_ps(v + c));
+        __m128i open = _mm_andnot_si128(_mm_castps_si128(_mm_cmpeq_ps(cost, off)), open_sse2(cover_bits(cover, c, 4)));
+        __m128i take = _mm_and_si128(open, _mm_or_si128(_mm_castps_si128(_mm_cmplt_ps(val, acc)), 
+                                                        _mm_cmpeq_epi32(best, none)));
+        acc = _mm_castsi128_ps(select_sse2(take, _mm_castps_si128(val), _mm_castps_si128(acc)));
+        best = select_sse2(take, idx, best);
+        idx = _mm_add_epi32(idx, _mm_set1_epi32(4));
+    }
+    alignas(16) float vals[4];
+    alignas(16) int32_t lanes[4];
+    _mm_store_ps(vals, acc);
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), best);
+    int tail_col;
+    float tail_val = reduced_argmin_scalar(row, v, ui, cover, c, n, tail_col);
+    return merge_argmin(vals, lanes, 4, tail_val, tail_col, col);
+}
+
+// AVX2
+
+template<typename T>
+MUNKRES_AVX2 inline T hmin_avx2(__m256i acc)
+{
+    alignas(32) T lanes[32 / sizeof(T)];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return *std::min_element(lanes, lanes + 32 / sizeof(T));
+}
+
+MUNKRES_AVX2 inline float hmin_avx2(__m256 acc)
+{
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    return *std::min_element(lanes, lanes + 8);
+}
+
+MUNKRES_AVX2 inline double hmin_avx2(__m256d acc)
+{
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, acc);
+    return *std::min_element(lanes, lanes + 4);
+}
+
+/* Cover bits widened to a lane mask, all ones where uncovered */
+MUNKRES_AVX2 inline __m256i open_avx2_i32(std::uint64_t bits)
+{
+    __m256i lane = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits)), lane), 
+                              _mm256_setzero_si256());
+}
+
+MUNKRES_AVX2 inline __m256i open_avx2_i64(std::uint64_t bits)
+{
+    __m256i lane = _mm256_setr_epi64x(1, 2, 4, 8);
+    return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(static_cast<long long>(bits)), lane), 
+                              _mm256_setzero_si256());
+}
+
+MUNKRES_AVX2 inline int32_t row_min_avx2(const int32_t* row, std::size_t n)
+{
+    __m256i acc = _mm256_set1_epi32(std::numeric_limits<int32_t>::max());
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8)
+        acc = _mm256_min_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + c)));
+    return std::min(hmin_avx2<int32_t>(acc), row_min_scalar(row + c, n - c));
+}
+
+MUNKRES_AVX2 inline int64_t row_min_avx2(const int64_t* row, std::size_t n)
+{
+    __m256i acc = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4) {
+        __m256i val = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + c));
+        acc = _mm256_blendv_epi8(acc, val, _mm256_cmpgt_epi64(acc, val));
+    }
+    return std::min(hmin_avx2<int64_t>(acc), row_min_scalar(row + c, n - c));
+}
+
+MUNKRES_AVX2 inline float row_min_avx2(const float* row, std::size_t n)
+{
+    __m256 acc = _mm256_set1_ps(forbidden<float>());
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8)
+        acc = _mm256_min_ps(acc, _mm256_loadu_ps(row + c));
+    return std::min(hmin_avx2(acc), row_min_scalar(row + c, n - c));
+}
+
+MUNKRES_AVX2 inline double row_min_avx2(const double* row, std::size_t n)
+{
+    __m256d acc = _mm256_set1_pd(forbidden<double>());
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4)
+        acc = _mm256_min_pd(acc, _mm256_loadu_pd(row + c));
+    return std::min(hmin_avx2(acc), row_min_scalar(row + c, n - c));
+}
+
+/* 4 integral costs extended to 64 bit lanes, the way static_cast<int64_t> extends them */
+MUNKRES_AVX2 inline __m256i load4_avx2(const int8_t* row)
+{
+    int32_t bytes;
+    std::memcpy(&bytes, row, sizeof(bytes));
+    return _mm256_cvtepi8_epi64(_mm_cvtsi32_si128(bytes));
+}
+
+MUNKRES_AVX2 inline __m256i load4_avx2(const uint8_t* row)
+{
+    int32_t bytes;
+    std::memcpy(&bytes, row, sizeof(bytes));
+    return _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes));
+}
+
+MUNKRES_AVX2 inline __m256i load4_avx2(const int16_t* row)
+{
+    return _mm256_cvtepi16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row)));
+}
+
+MUNKRES_AVX2 inline __m256i load4_avx2(const uint16_t* row)
+{
+    return _mm256_cvtepu16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row)));
+}
+
+MUNKRES_AVX2 inline __m256i load4_avx2(const int32_t* row)
+{
+    return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)));
+}
+
+MUNKRES_AVX2 inline __m256i load4_avx2(const uint32_t* row)
+{
+    return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)));
+}
+
+template<typename T>
+MUNKRES_AVX2 inline __m256i load4_avx2(const T* row)
+{
+    static_assert(sizeof(T) == 8, "64 bit costs are loaded as they are");
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row));
+}
+
+template<typename T>
+MUNKRES_AVX2 inline void min_update_avx2(int64_t* v, const T* row, int64_t ui, std::size_t n)
+{
+    const __m256i vu = _mm256_set1_epi64x(ui);
+    const __m256i off = _mm256_set1_epi64x(static_cast<int64_t>(forbidden<T>()));
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4) {
+        __m256i* dst = reinterpret_cast<__m256i*>(v + c);
+        __m256i cur = _mm256_loadu_si256(dst);
+        __m256i cost = load4_avx2(row + c);
+        __m256i val = _mm256_sub_epi64(cost, vu);
+        __m256i take = _mm256_andnot_si256(_mm256_cmpeq_epi64(cost, off), _mm256_cmpgt_epi64(cur, val));
+        _mm256_storeu_si256(dst, _mm256_blendv_epi8(cur, val, take));
+    }
+    min_update_scalar(v + c, row + c, ui, n - c);
+}
+
+MUNKRES_AVX2 inline void min_update_avx2(float* v, const float* row, float ui, std::size_t n)
+{
+    const __m256 vu = _mm256_set1_ps(ui);
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8)
+        _mm256_storeu_ps(v + c, _mm256_min_ps(_mm256_loadu_ps(v + c), 
+                                              _mm256_sub_ps(_mm256_loadu_ps(row + c), vu)));
+    min_update_scalar(v + c, row + c, ui, n - c);
+}
+
+MUNKRES_AVX2 inline void min_update_avx2(double* v, const double* row, double ui, std::size_t n)
+{
+    const __m256d vu = _mm256_set1_pd(ui);
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4)
+        _mm256_storeu_pd(v + c, _mm256_min_pd(_mm256_loadu_pd(v + c), 
+                                              _mm256_sub_pd(_mm256_loadu_pd(row + c), vu)));
+    min_update_scalar(v + c, row + c, ui, n - c);
+}
+
+template<typename T>
+MUNKRES_AVX2 inline int64_t reduced_argmin_avx2(const T* row, const int64_t* v, int64_t ui,
+                                                const std::uint64_t* cover, std::size_t n, int& col)
+{
+    const __m256i vu = _mm256_set1_epi64x(ui);
+    const __m256i none = _mm256_set1_epi64x(-1);
+    const __m256i off = _mm256_set1_epi64x(static_cast<int64_t>(forbidden<T>()));
+    __m256i acc = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+    __m256i best = none;
+    __m256i idx = _mm256_setr_epi64x(0, 1, 2, 3);
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4) {
+        __m256i cost = load4_avx2(row + c);
+        __m256i val = _mm256_sub_epi64(_mm256_sub_epi64(cost, vu), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + c)));
+        __m256i open = _mm256_andnot_si256(_mm256_cmpeq_epi64(cost, off), open_avx2_i64(cover_bits(cover, c, 4)));
+        __m256i take = _mm256_and_si256(open, 
+                                        _mm256_or_si256(_mm256_cmpgt_epi64(acc, val), _mm256_cmpeq_epi64(best, none)));
+        acc = _mm256_blendv_epi8(acc, val, take);
+        best = _mm256_blendv_epi8(best, idx, take);
+        idx = _mm256_add_epi64(idx, _mm256_set1_epi64x(4));
+    }
+    alignas(32) int64_t vals[4], lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(vals), acc);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+    int tail_col;
+    int64_t tail_val = reduced_argmin_scalar(row, v, ui, cover, c, n, tail_col);
+    return merge_argmin(vals, lanes, 4, tail_val, tail_col, col);
+}
+
+MUNKRES_AVX2 inline float reduced_argmin_avx2(const float* row, const float* v, float ui,
+                                              const std::uint64_t* cover, std::size_t n, int& col)
+{
+    const __m256 vu = _mm256_set1_ps(ui);
+    const __m256i none = _mm256_set1_epi32(-1);
+    const __m256 off = _mm256_set1_ps(forbidden<float>());
+    __m256 acc = _mm256_set1_ps(std::numeric_limits<float>::max());
+    __m256i best = none;
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8) {
+        __m256 cost = _mm256_loadu_ps(row + c);
+        __m256 val = _mm256_sub_ps(_mm256_sub_ps(cost, vu), _mm256_loadu_ps(v + c));
+        __m256i open = _mm256_andnot_si256(_mm256_castps_si256(_mm256_cmp_ps(cost, off, _CMP_EQ_OQ)), 
+                                           open_avx2_i32(cover_bits(cover, c, 8)));
+        __m256i take = _mm256_and_si256(open, _mm256_or_si256(_mm256_castps_si256(_mm256_cmp_ps(val, acc, _CMP_LT_OQ)),
+                                                              _mm256_cmpeq_epi32(best, none)));
+        acc = _mm256_blendv_ps(acc, val, _mm256_castsi256_ps(take));
+        best = _mm256_blendv_epi8(best, idx, take);
+        idx = _mm256_add_epi32(idx, _mm256_set1_epi32(8));
+    }
+    alignas(32) float vals[8];
+    alignas(32) int32_t lanes[8];
+    _mm256_store_ps(vals, acc);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+    int tail_col;
+    float tail_val = reduced_argmin_scalar(row, v, ui, cover, c, n, tail_col);
+    return merge_argmin(vals, lanes, 8, tail_val, tail_col, col);
+}
+
+MUNKRES_AVX2 inline double reduced_argmin_avx2(const double* row, const double* v, double ui,
+                                               const std::uint64_t* cover, std::size_t n, int& col)
+{
+    const __m256d vu = _mm256_set1_pd(ui);
+    const __m256i none = _mm256_set1_epi64x(-1);
+    const __m256d off = _mm256_set1_pd(forbidden<double>());
+    __m256d acc = _mm256_set1_pd(std::numeric_limits<double>::max());
+    __m256i best = none;
+    __m256i idx = _mm256_setr_epi64x(0, 1, 2, 3);
+    std::size_t c = 0;
+    for (; c + 4 <= n; c += 4) {
+        __m256d cost = _mm256_loadu_pd(row + c);
+        __m256d val = _mm256_sub_pd(_mm256_sub_pd(cost, vu), _mm256_loadu_pd(v + c));
+        __m256i open = _mm256_andnot_si256(_mm256_castpd_si256(_mm256_cmp_pd(cost, off, _CMP_EQ_OQ)), 
+                                           open_avx2_i64(cover_bits(cover, c, 4)));
+        __m256i take = _mm256_and_si256(open, 
+                                        _mm256_or_si256(_mm256_castpd_si256(_mm256_cmp_pd(val, acc, _CMP_LT_OQ)),
+                                                        _mm256_cmpeq_epi64(best, none)));
+        acc = _mm256_blendv_pd(acc, val, _mm256_castsi256_pd(take));
+        best = _mm256_blendv_epi8(best, idx, take);
+        idx = _mm256_add_epi64(idx, _mm256_set1_epi64x(4));
+    }
+    alignas(32) double vals[4];
+    alignas(32) int64_t lanes[4];
+    _mm256_store_pd(vals, acc);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+    int tail_col;
+    double tail_val = reduced_argmin_scalar(row, v, ui, cover, c, n, tail_col);
+    return merge_argmin(vals, lanes, 4, tail_val, tail_col, col);
+}
+
+// AVX-512: cover bits are the mask register, masked min leaves covered lanes alone
+
+// GCC 12 headers self-initialize the undefined vectors of some intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+MUNKRES_AVX512 inline int32_t row_min_avx512(const int32_t* row, std::size_t n)
+{
+    __m512i acc = _mm512_set1_epi32(std::numeric_limits<int32_t>::max());
+    std::size_t c = 0;
+    for (; c + 16 <= n; c += 16)
+        acc = _mm512_min_epi32(acc, _mm512_loadu_si512(row + c));
+    return std::min(_mm512_reduce_min_epi32(acc), row_min_scalar(row + c, n - c));
+}
+
+MUNKRES_AVX512 inline int64_t row_min_avx512(const int64_t* row, std::size_t n)
+{
+    __m512i acc = _mm512_set1_epi64(std::numeric_limits<int64_t>::max());
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8)
+        acc = _mm512_min_epi64(acc, _mm512_loadu_si512(row + c));
+    return std::min(static_cast<int64_t>(_mm512_reduce_min_epi64(acc)), row_min_scalar(row + c, n - c));
+}
+
+MUNKRES_AVX512 inline float row_min_avx512(const float* row, std::size_t n)
+{
+    __m512 acc = _mm512_set1_ps(forbidden<float>());
+    std::size_t c = 0;
+    for (; c + 16 <= n; c += 16)
+        acc = _mm512_min_ps(acc, _mm512_loadu_ps(row + c));
+    return std::min(_mm512_reduce_min_ps(acc), row_min_scalar(row + c, n - c));
+}
+
+MUNKRES_AVX512 inline double row_min_avx512(const double* row, std::size_t n)
+{
+    __m512d acc = _mm512_set1_pd(forbidden<double>());
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8)
+        acc = _mm512_min_pd(acc, _mm512_loadu_pd(row + c));
+    return std::min(_mm512_reduce_min_pd(acc), row_min_scalar(row + c, n - c));
+}
+
+/* 8 integral costs extended to 64 bit lanes, the way static_cast<int64_t> extends them */
+MUNKRES_AVX512 inline __m512i load8_avx512(const int8_t* row)
+{
+    return _mm512_cvtepi8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row)));
+}
+
+MUNKRES_AVX512 inline __m512i load8_avx512(const uint8_t* row)
+{
+    return _mm512_cvtepu8_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row)));
+}
+
+MUNKRES_AVX512 inline __m512i load8_avx512(const int16_t* row)
+{
+    return _mm512_cvtepi16_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)));
+}
+
+MUNKRES_AVX512 inline __m512i load8_avx512(const uint16_t* row)
+{
+    return _mm512_cvtepu16_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)));
+}
+
+MUNKRES_AVX512 inline __m512i load8_avx512(const int32_t* row)
+{
+    return _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row)));
+}
+
+MUNKRES_AVX512 inline __m512i load8_avx512(const uint32_t* row)
+{
+    return _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row)));
+}
+
+template<typename T>
+MUNKRES_AVX512 inline __m512i load8_avx512(const T* row)
+{
+    static_assert(sizeof(T) == 8, "64 bit costs are loaded as they are");
+    return _mm512_loadu_si512(row);
+}
+
+template<typename T>
+MUNKRES_AVX512 inline void min_update_avx512(int64_t* v, const T* row, int64_t ui, std::size_t n)
+{
+    const __m512i vu = _mm512_set1_epi64(ui);
+    const __m512i off = _mm512_set1_epi64(static_cast<int64_t>(forbidden<T>()));
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8) {
+        __m512i cur = _mm512_loadu_si512(v + c);
+        __m512i cost = load8_avx512(row + c);
+        _mm512_storeu_si512(v + c, _mm512_mask_min_epi64(cur, _mm512_cmpneq_epi64_mask(cost, off), cur, 
+                                                          _mm512_sub_epi64(cost, vu)));
+    }
+    min_update_scalar(v + c, row + c, ui, n - c);
+}
+
+MUNKRES_AVX512 inline void min_update_avx512(float* v, const float* row, float ui, std::size_t n)
+{
+    const __m512 vu = _mm512_set1_ps(ui);
+    std::size_t c = 0;
+    for (; c + 16 <= n; c += 16)
+        _mm512_storeu_ps(v + c, _mm512_min_ps(_mm512_loadu_ps(v + c), 
+                                              _mm512_sub_ps(_mm512_loadu_ps(row + c), vu)));
+    min_update_scalar(v + c, row + c, ui, n - c);
+}
+
+MUNKRES_AVX512 inline void min_update_avx512(double* v, const double* row, double ui, std::size_t n)
+{
+    const __m512d vu = _mm512_set1_pd(ui);
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8)
+        _mm512_storeu_pd(v + c, _mm512_min_pd(_mm512_loadu_pd(v + c), 
+                                              _mm512_sub_pd(_mm512_loadu_pd(row + c), vu)));
+    min_update_scalar(v + c, row + c, ui, n - c);
+}
+
+template<typename T>
+MUNKRES_AVX512 inline int64_t reduced_argmin_avx512(const T* row, const int64_t* v, int64_t ui,
+                                                    const std::uint64_t* cover, std::size_t n, int& col)
+{
+    const __m512i vu = _mm512_set1_epi64(ui);
+    const __m512i none = _mm512_set1_epi64(-1);
+    const __m512i off = _mm512_set1_epi64(static_cast<int64_t>(forbidden<T>()));
+    __m512i acc = _mm512_set1_epi64(std::numeric_limits<int64_t>::max());
+    __m512i best = none;
+    __m512i idx = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8) {
+        __m512i cost = load8_avx512(row + c);
+        __m512i val = _mm512_sub_epi64(_mm512_sub_epi64(cost, vu), _mm512_loadu_si512(v + c));
+        __mmask8 open = static_cast<__mmask8>(~cover_bits(cover, c, 8)) & _mm512_cmpneq_epi64_mask(cost, off);
+        __mmask8 take = open & (_mm512_cmpgt_epi64_mask(acc, val) | _mm512_cmpeq_epi64_mask(best, none));
+        acc = _mm512_mask_mov_epi64(acc, take, val);
+        best = _mm512_mask_mov_epi64(best, take, idx);
+        idx = _mm512_add_epi64(idx, _mm512_set1_epi64(8));
+    }
+    alignas(64) int64_t vals[8], lanes[8];
+    _mm512_store_si512(vals, acc);
+    _mm512_store_si512(lanes, best);
+    int tail_col;
+    int64_t tail_val = reduced_argmin_scalar(row, v, ui, cover, c, n, tail_col);
+    return merge_argmin(vals, lanes, 8, tail_val, tail_col, col);
+}
+
+MUNKRES_AVX512 inline float reduced_argmin_avx512(const float* row, const float* v, float ui,
+                                                  const std::uint64_t* cover, std::size_t n, int& col)
+{
+    const __m512 vu = _mm512_set1_ps(ui);
+    const __m512i none = _mm512_set1_epi32(-1);
+    const __m512 off = _mm512_set1_ps(forbidden<float>());
+    __m512 acc = _mm512_set1_ps(std::numeric_limits<float>::max());
+    __m512i best = none;
+    __m512i idx = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    std::size_t c = 0;
+    for (; c + 16 <= n; c += 16) {
+        __m512 cost = _mm512_loadu_ps(row + c);
+        __m512 val = _mm512_sub_ps(_mm512_sub_ps(cost, vu), _mm512_loadu_ps(v + c));
+        __mmask16 open = static_cast<__mmask16>(~cover_bits(cover, c, 16)) & _mm512_cmp_ps_mask(cost, off, _CMP_NEQ_UQ);
+        __mmask16 take = open & (_mm512_cmp_ps_mask(val, acc, _CMP_LT_OQ) | _mm512_cmpeq_epi32_mask(best, none));
+        acc = _mm512_mask_mov_ps(acc, take, val);
+        best = _mm512_mask_mov_epi32(best, take, idx);
+        idx = _mm512_add_epi32(idx, _mm512_set1_epi32(16));
+    }
+    alignas(64) float vals[16];
+    alignas(64) int32_t lanes[16];
+    _mm512_store_ps(vals, acc);
+    _mm512_store_si512(lanes, best);
+    int tail_col;
+    float tail_val = reduced_argmin_scalar(row, v, ui, cover, c, n, tail_col);
+    return merge_argmin(vals, lanes, 16, tail_val, tail_col, col);
+}
+
+MUNKRES_AVX512 inline double reduced_argmin_avx512(const double* row, const double* v, double ui,
+                                                   const std::uint64_t* cover, std::size_t n, int& col)
+{
+    const __m512d vu = _mm512_set1_pd(ui);
+    const __m512i none = _mm512_set1_epi64(-1);
+    const __m512d off = _mm512_set1_pd(forbidden<double>());
+    __m512d acc = _mm512_set1_pd(std::numeric_limits<double>::max());
+    __m512i best = none;
+    __m512i idx = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    std::size_t c = 0;
+    for (; c + 8 <= n; c += 8) {
+        __m512d cost = _mm512_loadu_pd(row + c);
+        __m512d val = _mm512_sub_pd(_mm512_sub_pd(cost, vu), _mm512_loadu_pd(v + c));
+        __mmask8 open = static_cast<__mmask8>(~cover_bits(cover, c, 8)) & _mm512_cmp_pd_mask(cost, off, _CMP_NEQ_UQ);
+        __mmask8 take = open & (_mm512_cmp_pd_mask(val, acc, _CMP_LT_OQ) | _mm512_cmpeq_epi64_mask(best, none));
+        acc = _mm512_mask_mov_pd(acc, take, val);
+        best = _mm512_mask_mov_epi64(best, take, idx);
+        idx = _mm512_add_epi64(idx, _mm512_set1_epi64(8));
+    }
+    alignas(64) double vals[8];
+    alignas(64) int64_t lanes[8];
+    _mm512_store_pd(vals, acc);
+    _mm512_store_si512(lanes, best);
+    int tail_col;
+    double tail_val = reduced_argmin_scalar(row, v, ui, cover, c, n, tail_col);
+    return merge_argmin(vals, lanes, 8, tail_val, tail_col, col);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#undef MUNKRES_SSE2
+#undef MUNKRES_AVX2
+#undef MUNKRES_AVX512
+
+// Dispatch on the CPU for the types that have kernels
+
+inline int32_t row_min(const int32_t* row, std::size_t n)
+{
+    switch (isa()) {
+        case Isa::AVX512: return row_min_avx512(row, n);
+        case Isa::AVX2:   return row_min_avx2(row, n);
+        case Isa::SSE2:   return row_min_sse2(row, n);
+        default:          return row_min_scalar(row, n);
+    }
+}
+
+inline int64_t row_min(const int64_t* row, std::size_t n)
+{
+    switch (isa()) {
+        case Isa::AVX512: return row_min_avx512(row, n);
+        case Isa::AVX2:   return row_min_avx2(row, n);
+        default:          return row_min_scalar(row, n);
+    }
+}
+
+inline float row_min(const float* row, std::size_t n)
+{
+    switch (isa()) {
+        case Isa::AVX512: return row_min_avx512(row, n);
+        case Isa::AVX2:   return row_min_avx2(row, n);
+        case Isa::SSE2:   return row_min_sse2(row, n);
+        default:          return row_min_scalar(row, n);
+    }
+}
+
+inline double row_min(const double* row, std::size_t n)
+{
+    switch (isa()) {
+        case Isa::AVX512: return row_min_avx512(row, n);
+        case Isa::AVX2:   return row_min_avx2(row, n);
+        default:          return row_min_scalar(row, n);
+    }
+}
+
+/* Integral costs that have a 64 bit lane loader */
+template<typename T>
+struct has_lanes : std::integral_constant<bool,
+    std::is_same<T, int8_t>::value || std::is_same<T, uint8_t>::value ||
+    std::is_same<T, int16_t>::value || std::is_same<T, uint16_t>::value ||
+    std::is_same<T, int32_t>::value || std::is_same<T, uint32_t>::value ||
+    std::is_same<T, int64_t>::value || std::is_same<T, uint64_t>::value> {};
+
+template<typename T>
+typename std::enable_if<has_lanes<T>::value>::type
+min_update(int64_t* v, const T* row, int64_t ui, std::size_t n)
+{
+    switch (isa()) {
+        case Isa::AVX512: min_update_avx512(v, row, ui, n); break;
+        case Isa::AVX2:   min_update_avx2(v, row, ui, n); break;
+        default:          min_update_scalar(v, row, ui, n); break;
+    }
+}
+
+inline void min_update(float* v, const float* row, float ui, std::size_t n)
+{
+    switch (isa()) {
+        case Isa::AVX512: min_update_avx512(v, row, ui, n); break;
+        case Isa::AVX2:   min_update_avx2(v, row, ui, n); break;
+        case Isa::SSE2:   min_update_sse2(v, row, ui, n); break;
+        default:          min_update_scalar(v, row, ui, n); break;
+    }
+}
+
+inline void min_update(double* v, const double* row, double ui, std::size_t n)
+{
+    switch (isa()) {
+        case Isa::AVX512: min_update_avx512(v, row, ui, n); break;
+        case Isa::AVX2:   min_update_avx2(v, row, ui, n); break;
+        default:          min_update_scalar(v, row, ui, n); break;
+    }
+}
+
+template<typename T>
+typename std::enable_if<has_lanes<T>::value, int64_t>::type
+reduced_argmin(const T* row, const int64_t* v, int64_t ui, const std::uint64_t* cover, std::size_t n, int& col)
+{
+    switch (isa()) {
+        case Isa::AVX512: return reduced_argmin_avx512(row, v, ui, cover, n, col);
+        case Isa::AVX2:   return reduced_argmin_avx2(row, v, ui, cover, n, col);
+        default:          return reduced_argmin_scalar(row, v, ui, cover, n, col);
+    }
+}
+
+inline float reduced_argmin(const float* row, const float* v, float ui, 
+                            const std::uint64_t* cover, std::size_t n, int& col)
+{
+    switch (isa()) {
+        case Isa::AVX512: return reduced_argmin_avx512(row, v, ui, cover, n, col);
+        case Isa::AVX2:   return reduced_argmin_avx2(row, v, ui, cover, n, col);
+        case Isa::SSE2:   return reduced_argmin_sse2(row, v, ui, cover, n, col);
+        default:          return reduced_argmin_scalar(row, v, ui, cover, n, col);
+    }
+}
+
+inline double reduced_argmin(const double* row, const double* v, double ui, 
+                             const std::uint64_t* cover, std::size_t n, int& col)
+{
+    switch (isa()) {
+        case Isa::AVX512: return reduced_argmin_avx512(row, v, ui, cover, n, col);
+        case Isa::AVX2:   return reduced_argmin_avx2(row, v, ui, cover, n, col);
+        default:          return reduced_argmin_scalar(row, v, ui, cover, n, col);
+    }
+}
+
+#endif // MUNKRES_X86_SIMD
+
+/* Generic entry points, the more specialized overloads above win when the kernels are
+ * compiled in.  v and ui are the offsets, of the potential type of the costs. */
+template<typename T>
+T row_min(const T* row, std::size_t n)
+{
+    return row_min_scalar(row, n);
+}
+
+template<typename T, typename P>
+void min_update(P* v, const T* row, P ui, std::size_t n)
+{
+    min_update_scalar(v, row, ui, n);
+}
+
+template<typename T, typename P>
+P reduced_argmin(const T* row, const P* v, P ui, const std::uint64_t* cover, std::size_t n, int& col)
+{
+    return reduced_argmin_scalar(row, v, ui, cover, n, col);
+}
+
+} // end of namespace simd
+
+/* Ticks of the instrumentation clock: TSC cycles on x86, nanoseconds elsewhere */
+inline std::uint64_t stat_ticks()
+{
+#if defined(MUNKRES_STATS) && defined(MUNKRES_X86_SIMD)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/* What the last solve did, recorded only when built with MUNKRES_STATS.  runs[s] and
+ * ticks[s] count the passes through step s of the Munkres engine and the time spent in
+ * them, find_a_zero and find_smallest the time inside those two searches of steps 4 
+ * and 6.  An augmentation is one step 5, or one row inserted by the shortest path 
+ * engine, and its path length is the number of pairs it assigned.  init_assigned 
+ * counts the rows matched before the first augmentation, each one an augmentation 
+ * saved, and init_ticks the time that took.  peak_bytes is the memory held by the
+ * workspace buffers. */
+struct SolveStats {
+    static constexpr bool enabled =
+#ifdef MUNKRES_STATS
+        true;
+#else
+        false;
+#endif
+    
+    std::uint64_t runs[8] = {};
+    std::uint64_t ticks[8] = {};
+    std::uint64_t find_a_zero = 0;
+    std::uint64_t find_smallest = 0;
+    std::uint64_t total_ticks = 0;
+    
+    std::uint64_t augmentations = 0;
+    std::uint64_t path_total = 0;
+    std::uint64_t path_max = 0;
+    
+    std::uint64_t init_assigned = 0;
+    std::uint64_t init_ticks = 0;
+    
+    std::size_t peak_bytes = 0;
+    
+    void clear() {*this = SolveStats();}
+    
+    void add_init(std::uint64_t assigned)
+    {
+        (void)assigned; // unused without MUNKRES_STATS
+        MUNKRES_STAT(init_assigned += assigned;)
+    }
+    
+    void add_path(std::uint64_t length)
+    {
+        (void)length;
+        MUNKRES_STAT(++augmentations;
+                     path_total += length;
+                     path_max = std::max(path_max, length);)
+    }
+};
+
+/* Adds the ticks elapsed during its lifetime to a counter */
+class StatTimer {
+public:
+    explicit StatTimer(std::uint64_t& counter) : counter_ (counter), start_ {stat_ticks()} {}
+    ~StatTimer() {counter_ += stat_ticks() - start_;}
+    
+    StatTimer(const StatTimer&) = delete;
+    StatTimer& operator=(const StatTimer&) = delete;
+    
+private:
+    std::uint64_t& counter_;
+    std::uint64_t start_;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const SolveStats& stats)
+{
+    for (int s=1; s<=6; ++s)
+        os << "step" << s << ": " << stats.runs[s] << " runs, " << stats.ticks[s] << " ticks\n";
+    os << "find_a_zero: " << stats.find_a_zero << " ticks\n"
+       << "find_smallest: " << stats.find_smallest << " ticks\n"
+       << "augmentations: " << stats.augmentations << ", path length mean "
+       << (stats.augmentations ? double(stats.path_total) / stats.augmentations : 0.0)
+       << " max " << stats.path_max << "\n"
+       << "initialization: " << stats.init_assigned << " rows assigned, " << stats.init_ticks << " ticks\n"
+       << "total: " << stats.total_ticks << " ticks, peak " << stats.peak_bytes << " bytes\n";
+    return os;
+}
+
+/* Thrown by a solve stopped before it finished, see StopCondition */
+class SolveCancelled : public std::runtime_error {
+public:
+    explicit SolveCancelled(const char* what) : std::runtime_error(what) {}
+};
+
+/* When a solve should give up: a deadline, a flag raised by another thread, or both.
+ * The engines poll it between iterations of their outer loops (the Munkres steps,
+ * the rows of the shortest path engine, the bidding rounds of the auction) and throw
+ * SolveCancelled once it holds.  The default one never stops and costs two compares
+ * per poll. */
+class StopCondition {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    StopCondition() = default;
+    
+    explicit StopCondition(Clock::time_point deadline,
+                           const std::atomic<bool>* flag = nullptr)
+        : deadline_ {deadline}, flag_ {flag} {}
+    
+    // why the solve should stop, nullptr while it may go on
+    const char* reason() const
+    {
+        if (flag_ != nullptr && flag_->load(std::memory_order_relaxed))
+            return "Solve cancelled";
+        if (deadline_ != Clock::time_point::max() && Clock::now() >= deadline_)
+            return "Solve deadline passed";
+        return nullptr;
+    }
+    
+    void check() const
+    {
+        if (const char* why = reason())
+            throw SolveCancelled(why);
+    }
+    
+private:
+    Clock::time_point deadline_ = Clock::time_point::max();
+    const std::atomic<bool>* flag_ = nullptr;
+};
+
+/* Budget of an anytime solve: a deadline, a number of iterations (passes through the
+ * step loop of the Munkres engine, rows inserted by the shortest path engine), or both.
+ * Unlike a StopCondition, running out of it is not an error: the solve stops where it
+ * is and completes its partial assignment greedily, see BoundedSolution.  The default
+ * one is unlimited. */
+class Budget {
+public:
+    using Clock = StopCondition::Clock;
+    
+    Budget() = default;
+    
+    explicit Budget(Clock::duration time,
+                    std::uint64_t iterations = std::numeric_limits<std::uint64_t>::max())
+        : deadline_ {time == Clock::duration::max() ? Clock::time_point::max() : Clock::now() + time},
+          iterations_ {iterations} {}
+    
+    static Budget steps(std::uint64_t iterations) {return Budget(Clock::duration::max(), iterations);}
+    
+    bool unlimited() const
+    {
+        return deadline_ == Clock::time_point::max() && 
+               iterations_ == std::numeric_limits<std::uint64_t>::max();
+    }
+    
+    // whether a solve that did done iterations must stop
+    bool spent(std::uint64_t done) const
+    {
+        return done >= iterations_ ||
+               (deadline_ != Clock::time_point::max() && Clock::now() >= deadline_);
+    }
+    
+private:
+    Clock::time_point deadline_ = Clock::time_point::max();
+    std::uint64_t iterations_ = std::numeric_limits<std::uint64_t>::max();
+};
+
+/* Handle negative elements if present. If allowed = true there is nothing to do, the 
+ * reduced costs of step 1 are non-negative whatever the sign of the input. 
+ * Else throw an exception */
+template<typename T>
+void handle_negatives(const MatrixView<T>& matrix, 
+                      bool allowed = true)
+{
+    if (allowed)
+        return;
+    
+    for (std::size_t r=0; r<matrix.rows(); ++r)
+        for (std::size_t c=0; c<matrix.cols(); ++c)
+            if (matrix[r][c] < 0)
+                throw std::runtime_error("Only non-negative values allowed");
+}
+
+/* Tolerance of the zero tests.  Integral costs are compared exactly.  Floating point
+ * reduced costs carry the rounding error of the offsets, so a reduced cost within 
+ * tolerance counts as a zero.  A negative tolerance picks one from the data: each offset
+ * sums at most rows+cols minima, which bounds its error by (rows+cols)*epsilon*max|C|. */
+template<typename T>
+T zero_tolerance(const MatrixView<T>&, T, std::false_type)
+{
+    return T(0);
+}
+
+template<typename T>
+T auto_tolerance(const MatrixView<T>& matrix, T largest)
+{
+    return (matrix.rows() + matrix.cols()) * std::numeric_limits<T>::epsilon() * largest;
+}
+
+template<typename T>
+T zero_tolerance(const MatrixView<T>& matrix, T tolerance, std::true_type)
+{
+    if (tolerance >= 0)
+        return tolerance;
+    
+    T largest = 0;
+    for (std::size_t r=0; r<matrix.rows(); ++r)
+        for (std::size_t c=0; c<matrix.cols(); ++c)
+            if (!is_forbidden(matrix[r][c]))
+                largest = std::max(largest, std::abs(matrix[r][c]));
+    
+    return auto_tolerance(matrix, largest);
+}
+
+template<typename T>
+inline bool is_zero(T val, T tolerance)
+{
+    return val <= tolerance; // reduced costs are never meaningfully negative
+}
+
+/* Type of the shortest path potentials, which may go negative: int64_t for integral 
+ * costs, so that every cost of a 32 bit type, unsigned ones included, and the path 
+ * lengths built from them have room, floating point costs as they are */
+template<typename T, bool = std::is_floating_point<T>::value>
+struct potential {
+    using type = std::int64_t;
+};
+
+template<typename T>
+struct potential<T, true> {
+    using type = T;
+};
+
+/* The cost matrix is never modified.  Instead every row r has an offset u(r) and every
+ * col c an offset v(c), and the steps work on the reduced cost C(r,c) - u(r) - v(c),
+ * which is what the classic algorithm would have written in the matrix.  The offsets
+ * have the potential type of the costs, so for integral costs they and the reduced 
+ * costs are worked out in int64_t while the costs are read as they are. */
+template<typename T, typename P>
+inline P reduced_cost(const MatrixView<T>& matrix,
+                      const std::vector<P>& u,
+                      const std::vector<P>& v,
+                      int r,
+                      int c)
+{
+    return static_cast<P>(matrix[r][c]) - u[r] - v[c];
+}
+
+/* For each row of the matrix, find the smallest element and subtract it from every 
+ * element in its row.  
+ * For each col of the matrix, find the smallest element and subtract it from every 
+ * element in its col. Go to Step 2. 
+ * Subtracting means recording the smallest element in u (rows) and v (cols).
+ * The matrix has rows <= cols. When it is wider than tall some columns stay 
+ * unassigned, so only the rows are reduced: a col reduction would credit columns 
+ * the optimal assignment may never use.  A row (or, square, a col) with nothing but
+ * forbidden cells leaves no feasible assignment. */
+template<typename T, typename P>
+void step1(const MatrixView<T>& matrix, 
+           std::vector<P>& u,
+           std::vector<P>& v,
+           ThreadPool* pool,
+           int& step)
+{
+    std::size_t rows = matrix.rows();
+    std::size_t cols = matrix.cols();
+    
+    // process rows
+    parallel_for(pool, rows, rows*cols, [&](std::size_t b, std::size_t e) {
+        for (std::size_t i=b; i<e; ++i) {
+            T least = simd::row_min(matrix[i], cols);
+            u[i] = is_forbidden(least) ? forbidden<P>() : static_cast<P>(least);
+        }
+    });
+    
+    for (std::size_t i=0; i<rows; ++i)
+        if (is_forbidden(u[i]))
+            throw std::runtime_error("No feasible assignment: a row has no allowed column");
+    
+    if (rows < cols) {
+        step = 2;
+        return;
+    }
+    
+    // process cols, each chunk of cols walks the rows to keep memory access sequential
+    parallel_for(pool, cols, rows*cols, [&](std::size_t b, std::size_t e) {
+        std::fill(v.begin() + b, v.begin() + e, forbidden<P>());
+        for (std::size_t i=0; i<rows; ++i)
+            simd::min_update(v.data() + b, matrix[i] + b, u[i], e - b);
+    });
+    
+    for (std::size_t c=0; c<cols; ++c)
+        if (is_forbidden(v[c]))
+            throw std::runtime_error("No feasible assignment: a column has no allowed row");
+   
+    step = 2;
+}
+
+/* Find a zero (Z) in the resulting matrix.  If there is no starred zero in its row or 
+ * column, star Z. Repeat for each element in the matrix. Go to Step 3.  In this step, 
+ * we introduce the star and prime index arrays that replace the classic mask matrix M.
+ * StarInRow(i)=j and StarInCol(j)=i if C(i,j) is a starred zero, PrimeInRow(i)=j if 
+ * C(i,j) is a primed zero, -1 meaning none.  There is at most one star per row and col
+ * and at most one prime per row, so O(n) memory holds everything M did.
+ * In the nested loop (over indices i and j) we check to see if C(i,j) is a zero value 
+ * and if its column or row does not have a star yet.  If not then we star this zero. */
+template<typename T, typename P>
+void step2(const MatrixView<T>& matrix, 
+           const std::vector<P>& u,
+           const std::vector<P>& v,
+           std::vector<int>& StarInRow,
+           std::vector<int>& StarInCol,
+           P tolerance,
+           int& step)
+{
+    int rows = matrix.rows();
+    int cols = matrix.cols();
+    
+    for (int r=0; r<rows; ++r) 
+        for (int c=0; c<cols; ++c) 
+            if (!is_forbidden(matrix[r][c]) && is_zero(reduced_cost(matrix, u, v, r, c), tolerance))
+                if (StarInRow[r] == -1 && StarInCol[c] == -1) {
+                    StarInRow[r] = c;
+                    StarInCol[c] = r;
+                    break; // row r has its star
+                }
+    
+    step = 3;
+}
+
+
+/* Cover each column containing a starred zero.  If K columns are covered, the starred 
+ * zeros describe a complete set of unique assignments.  In this case, Go to DONE, 
+ * otherwise, Go to Step 4. Once we have searched the entire cost matrix, we count the 
+ * number of independent zeros found.  If we have found (and starred) K independent zeros 
+ * then we are done.  If not we procede to Step 4. K is the number of rows, the smaller
+ * dimension.*/
+void step3(const std::vector<int>& StarInCol, 
+           CoverSet& ColCover,
+           int K,
+           int& step)
+{
+    int sz = StarInCol.size();
+    int colcount = 0;
+    
+    for (int c=0; c<sz; ++c)
+        if (StarInCol[c] != -1) {
+            ColCover.set(c);
+            colcount++;
+        }
+    
+    if (colcount >= K) {
+        step = 7; // solution found
+    }
+    else {
+        step = 4;
+    }
+}
+
+// Following functions to support step 4
+
+/* State of the uncovered zero search.  Between two augmentations rows only get 
+ * covered and columns only get uncovered, so for every uncovered row we can keep
+ * Slack(r), its smallest value over the uncovered columns, and SlackCol(r), where it
+ * is, -1 while every uncovered column of the row is forbidden.  Rows whose slack is
+ * zero wait in Zeros, each one holding an uncovered zero.
+ * fresh is set whenever a new augmentation starts and the slack must be rebuilt.
+ * tolerance is the bound of the zero tests, see zero_tolerance.  The slack is a reduced
+ * cost, and has the potential type P of the offsets. */
+template<typename P>
+struct ZeroSearch {
+    std::vector<P> Slack;
+    std::vector<int> SlackCol;
+    std::vector<int> Zeros;
+    bool fresh = true;
+    P tolerance = 0;
+    
+    void reset(std::size_t sz)
+    {
+        Slack.assign(sz, 0);
+        SlackCol.assign(sz, -1);
+        Zeros.clear();
+        Zeros.reserve(sz);
+        fresh = true;
+    }
+};
+
+/* O(rows*cols) scan computing the slack of every row, done once per augmentation */
+template<typename T, typename P>
+void init_slack(ZeroSearch<P>& search,
+                const MatrixView<T>& matrix,
+                const std::vector<P>& u,
+                const std::vector<P>& v,
+                const CoverSet& ColCover,
+                ThreadPool* pool)
+{
+    int sz = matrix.rows();
+    int cols = matrix.cols();
+    
+    parallel_for(pool, sz, std::size_t(sz)*cols, [&](std::size_t b, std::size_t e) {
+        for (int r=b; r<static_cast<int>(e); ++r) {
+            const T* row = matrix[r];
+            int mincol;
+            P minval = simd::reduced_argmin(row, v.data(), u[r], ColCover.data(), cols, mincol);
+            
+            search.Slack[r] = minval;
+            search.SlackCol[r] = mincol;
+        }
+    });
+    
+    search.Zeros.clear();
+    for (int r=0; r<sz; ++r)
+        if (is_zero(search.Slack[r], search.tolerance))
+            search.Zeros.push_back(r);
+    
+    search.fresh = false;
+}
+
+/* Column c was just uncovered: fold it into the slack of every uncovered row, O(rows) */
+template<typename T, typename P>
+void uncover_col(int c, 
+                 ZeroSearch<P>& search,
+                 const MatrixView<T>& matrix,
+                 const std::vector<P>& u,
+                 const std::vector<P>& v,
+                 const CoverSet& RowCover)
+{
+    RowCover.for_each_clear([&](std::size_t r) {
+        T cost = matrix[r][c];
+        if (is_forbidden(cost))
+            return;
+        P val = static_cast<P>(cost) - u[r] - v[c];
+        if (val < search.Slack[r]) {
+            search.Slack[r] = val;
+            search.SlackCol[r] = c;
+            if (is_zero(val, search.tolerance))
+                search.Zeros.push_back(r);
+        }
+    });
+}
+
+/* Pop candidates until one is still uncovered, -1 if there is none left */
+template<typename P>
+void find_a_zero(int& row, 
+                 int& col,
+                 ZeroSearch<P>& search,
+                 const CoverSet& RowCover)
+{
+    row = -1;
+    col = -1;
+    
+    while (!search.Zeros.empty()) {
+        int r = search.Zeros.back();
+        search.Zeros.pop_back();
+        
+        if (!RowCover[r]) {
+            row = r;
+            col = search.SlackCol[r];
+            break;
+        }
+    }
+}
+
+
+/* Find a noncovered zero and prime it.  If there is no starred zero in the row containing
+ * this primed zero, Go to Step 5.  Otherwise, cover this row and uncover the column 
+ * containing the starred zero. Continue in this manner until there are no uncovered zeros
+ * left. Save the smallest uncovered value and Go to Step 6. */
+template<typename T, typename P>
+void step4(const MatrixView<T>& matrix, 
+           const std::vector<P>& u,
+           const std::vector<P>& v,
+           const std::vector<int>& StarInRow,
+           std::vector<int>& PrimeInRow,
+           CoverSet& RowCover,
+           CoverSet& ColCover,
+           ZeroSearch<P>& search,
+           ThreadPool* pool,
+           SolveStats& stats,
+           int& path_row_0,
+           int& path_col_0,
+           int& step)
+{
+    (void)stats; // unused without MUNKRES_STATS
+    int row = -1;
+    int col = -1;
+    bool done = false;
+    
+    if (search.fresh)
+        init_slack(search, matrix, u, v, ColCover, pool);
+
+    while (!done){
+        {
+            MUNKRES_STAT(StatTimer timer (stats.find_a_zero);)
+            find_a_zero(row, col, search, RowCover);
+        }
+        
+        if (row == -1){
+            done = true;
+            step = 6;
+        }
+        else {
+            PrimeInRow[row] = col;
+            if (StarInRow[row] != -1) {
+                RowCover.set(row);
+                ColCover.reset(StarInRow[row]);
+                uncover_col(StarInRow[row], search, matrix, u, v, RowCover);
+            }
+            else {
+                done = true;
+                step = 5;
+                path_row_0 = row;
+                path_col_0 = col;
+            }
+        }
+    }
+}
+
+// Following functions to support step 5
+
+/* Star each primed zero of the path. Starred zeros of the path lose their star
+ * implicitly: the prime before each of them takes over its column, and the prime 
+ * after it takes over its row. */
+void augment_path(const Matrix<int>& path, 
+                  int path_count, 
+                  std::vector<int>& StarInRow,
+                  std::vector<int>& StarInCol)
+{
+    for (int p = 0; p < path_count; p += 2) {
+        StarInRow[path[p][0]] = path[p][1];
+        StarInCol[path[p][1]] = path[p][0];
+    }
+}
+
+inline void erase_primes(std::vector<int>& PrimeInRow)
+{
+    for (auto& n: PrimeInRow) n = -1;
+}
+
+
+/* Construct a series of alternating primed and starred zeros as follows.  
+ * Let Z0 represent the uncovered primed zero found in Step 4.  Let Z1 denote the 
+ * starred zero in the column of Z0 (if any). Let Z2 denote the primed zero in the 
+ * row of Z1 (there will always be one).  Continue until the series terminates at a 
+ * primed zero that has no starred zero in its column.  Unstar each starred zero of 
+ * the series, star each primed zero of the series, erase all primes and uncover every 
+ * line in the matrix.  Return to Step 3.  You may notice that Step 5 seems vaguely 
+ * familiar.  It is a verbal description of the augmenting path algorithm (for solving
+ * the maximal matching problem). */
+void step5(Matrix<int>& path, 
+           int path_row_0, 
+           int path_col_0, 
+           std::vector<int>& StarInRow,
+           std::vector<int>& StarInCol,
+           std::vector<int>& PrimeInRow,
+           CoverSet& RowCover,
+           CoverSet& ColCover,
+           SolveStats& stats,
+           int& step)
+{
+    int path_count = 1;
+    
+    path[path_count - 1][0] = path_row_0;
+    path[path_count - 1][1] = path_col_0;
+    
+    bool done = false;
+    while (!done) {
+        int r = StarInCol[path[path_count - 1][1]];
+        if (r > -1) {
+            path_count += 1;
+            path[path_count - 1][0] = r;
+            path[path_count - 1][1] = path[path_count - 2][1];
+        }
+        else {done = true;}
+        
+        if (!done) {
+            int c = PrimeInRow[path[path_count - 1][0]];
+            path_count += 1;
+            path[path_count - 1][0] = path[path_count - 2][0];
+            path[path_count - 1][1] = c;
+        }
+    }
+    
+    augment_path(path, path_count, StarInRow, StarInCol);
+    stats.add_path((path_count + 1) / 2);
+    RowCover.clear();
+    ColCover.clear();
+    erase_primes(PrimeInRow);
+    
+    step = 3;
+}
+
+// methods to support step 6
+
+/* Smallest slack of the uncovered rows.  Returns false when none of them has an 
+ * allowed uncovered column: no augmenting path is left, the problem is infeasible. */
+template<typename P>
+bool find_smallest(P& minval, 
+                   const ZeroSearch<P>& search, 
+                   const CoverSet& RowCover,
+                   ThreadPool* pool)
+{
+    std::mutex m;
+    bool found = false;
+    
+    // per chunk partial minimum, merged under the lock
+    parallel_for(pool, RowCover.size(), RowCover.size(), [&](std::size_t b, std::size_t e) {
+        P partial = std::numeric_limits<P>::max();
+        bool any = false;
+        RowCover.for_each_clear(b, e, [&](std::size_t r) {
+            if (search.SlackCol[r] != -1 && (!any || partial > search.Slack[r])) {
+                partial = search.Slack[r];
+                any = true;
+            }
+        });
+        
+        std::lock_guard<std::mutex> lock (m);
+        if (any)
+            minval = found ? std::min(minval, partial) : partial;
+        found = found || any;
+    });
+    
+    return found;
+}
+
+/* Add the value found in Step 4 to every element of each covered row, and subtract it 
+ * from every element of each uncovered column.  Return to Step 4 without altering any
+ * stars, primes, or covered lines. Notice that this step uses the smallest uncovered 
+ * value in the cost matrix to modify the matrix.  Even though this step refers to the
+ * value being found in Step 4 it is more convenient to wait until you reach Step 6 
+ * before searching for this value.  It may seem that since the values in the cost 
+ * matrix are being altered, we would lose sight of the original problem.  
+ * However, we are only changing certain values that have already been tested and 
+ * found not to be elements of the minimal assignment.  Also we are only changing the 
+ * values by an amount equal to the smallest value in the cost matrix, so we will not
+ * jump over the optimal (i.e. minimal assignment) with this change.
+ * The smallest uncovered value is the smallest slack, and every uncovered row loses 
+ * exactly minval on its uncovered columns, so the slack stays valid after the update.
+ * The matrix itself is untouched: adding to a row lowers u, subtracting from a column
+ * raises v, so the whole step is O(n). */
+template<typename P>
+void step6(std::vector<P>& u,
+           std::vector<P>& v,
+           const CoverSet& RowCover,
+           const CoverSet& ColCover,
+           ZeroSearch<P>& search,
+           ThreadPool* pool,
+           SolveStats& stats,
+           int& step)
+{
+    (void)stats; // unused without MUNKRES_STATS
+    P minval = std::numeric_limits<P>::max();
+    {
+        MUNKRES_STAT(StatTimer timer (stats.find_smallest);)
+        if (!find_smallest(minval, search, RowCover, pool))
+            throw std::runtime_error("No feasible assignment: the allowed pairs cannot match every row");
+    }
+    
+    int rows = u.size();
+    for (int r = 0; r < rows; r++)
+        if (RowCover[r]) {
+            u[r] -= minval;
+        }
+        else if (search.SlackCol[r] != -1) {
+            search.Slack[r] -= minval;
+            if (is_zero(search.Slack[r], search.tolerance))
+                search.Zeros.push_back(r);
+        }
+    
+    ColCover.for_each_clear([&](std::size_t c) {v[c] += minval;});
+    
+    step = 4;
+}
+
+/* Scratch vectors of the shortest augmenting path engine. Index 0 is a virtual column 
+ * holding the row being inserted; p[j] is the row assigned to col j (1-based, 0 = free) */
+template<typename P>
+struct PathBuffers {
+    std::vector<P> u;
+    std::vector<P> v;
+    std::vector<P> minv;
+    std::vector<int> p;
+    std::vector<int> way;
+    std::vector<char> used;
+    std::vector<int> free; // rows initial_assignment() left for augment_row()
+    
+    void reset(std::size_t rows, std::size_t cols)
+    {
+        u.assign(rows+1, 0);
+        v.assign(cols+1, 0);
+        minv.assign(cols+1, 0);
+        p.assign(cols+1, 0);
+        way.assign(cols+1, 0);
+        used.assign(cols+1, 0);
+        free.reserve(rows);
+        free.clear();
+    }
+};
+
+/* Shortest augmenting path engine (Jonker-Volgenant style). Instead of walking the 
+ * step machine above, keep dual potentials u (rows) and v (cols) such that
+ * C(i,j) - u(i) - v(j) >= 0, with equality on assigned pairs, and when cols outnumber
+ * rows v(j) <= 0 and v(j) = 0 on free cols.  augment_row() inserts the free row i (1-based): it grows a Dijkstra-like
+ * tree of reduced costs from that row.  minv holds the slack of every column (the smallest
+ * reduced cost reaching it from the tree) and way the column we came from, so each
+ * row is added with O(rows*cols) work and the whole solve is O(rows^2*cols).  Rows must 
+ * not outnumber cols, columns left with p[j] = 0 stay free.  The resulting assignment 
+ * is written as starred zeros, exactly like the Munkres steps.  The costs are only read
+ * a whole row at a time, so matrix may be a MatrixView or the RowCache of a cost 
+ * function.  Returns the number of cols the augmentation reassigned.  Forbidden cells
+ * are skipped and allowed(r, c) may forbid more pairs (0-based); -1 is returned, and 
+ * buf left half updated, when what is left gives row i no augmenting path. */
+struct AnyPair {
+    bool operator()(int, int) const {return true;}
+};
+
+template<typename Costs, typename P, typename Allowed = AnyPair>
+int augment_row(Costs& matrix,
+                PathBuffers<P>& buf,
+                int i,
+                Allowed allowed = Allowed())
+{
+    const P INF = std::numeric_limits<P>::max();
+    
+    int cols = matrix.cols();
+    
+    auto& u = buf.u;
+    auto& v = buf.v;
+    auto& p = buf.p;
+    auto& way = buf.way;
+    auto& minv = buf.minv;
+    auto& used = buf.used;
+    
+    p[0] = i;
+    int j0 = 0;
+    std::fill(minv.begin(), minv.end(), INF);
+    std::fill(used.begin(), used.end(), 0);
+    
+    do {
+        used[j0] = 1;
+        int i0 = p[j0];
+        int j1 = 0;
+        P delta = INF;
+        const auto* row = matrix[i0-1];
+        
+        for (int j=1; j<=cols; ++j)
+            if (!used[j]) {
+                if (!is_forbidden(row[j-1]) && allowed(i0-1, j-1)) {
+                    P cur = static_cast<P>(row[j-1]) - u[i0] - v[j];
+                    if (cur < minv[j]) {
+                        minv[j] = cur;
+                        way[j] = j0;
+                    }
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+        
+        if (j1 == 0)
+            return -1;
+        
+        for (int j=0; j<=cols; ++j)
+            if (used[j]) {
+                u[p[j]] += delta;
+                v[j] -= delta;
+            }
+            else if (minv[j] != INF) {
+                minv[j] -= delta; // unreached cols stay INF
+            }
+        
+        j0 = j1;
+    } while (p[j0] != 0);
+    
+    // augment along the alternating path back to the virtual column
+    int length = 0;
+    do {
+        int j1 = way[j0];
+        p[j0] = p[j1];
+        j0 = j1;
+        ++length;
+    } while (j0 != 0);
+    
+    return length;
+}
+
+/* Initialization of LAPJV (Jonker & Volgenant, 1987), which assigns most rows before
+ * any shortest path is grown.  On a square problem: column reduction (v(j) the col 
+ * minimum, its row takes the col if still free), reduction transfer (a row holding one
+ * col moves its slack onto it) and two passes of augmenting row reduction (a free row 
+ * takes its cheapest col, lowering v there to its second cheapest, and the row pushed
+ * out tries again).  With more cols than rows, v(j) must stay 0 on free cols, so there
+ * is a row reduction instead of the first two.  Each phase is a pass over the rows, 
+ * so Costs may be a RowCache too.  On return u, v and p satisfy the invariants of
+ * augment_row() and buf.free holds the rows still free (1-based).  Returns the number
+ * of rows assigned. */
+template<typename Costs, typename P>
+std::size_t initial_assignment(Costs& matrix, PathBuffers<P>& buf)
+{
+    const P INF = std::numeric_limits<P>::max();
+    
+    int rows = matrix.rows();
+    int cols = matrix.cols();
+    
+    auto& u = buf.u;
+    auto& v = buf.v;
+    auto& p = buf.p;
+    auto& x = buf.way;    // col of each row, 0 = none
+    auto& held = buf.used; // cols a row got from the column reduction, capped at 2
+    auto& free = buf.free;
+    
+    std::fill(p.begin(), p.end(), 0);
+    std::fill(x.begin(), x.end(), 0);
+    std::fill(held.begin(), held.end(), 0);
+    free.clear();
+    
+    if (rows == cols) {
+        // column reduction, row by row: p(j) the first row reaching the minimum of col j
+        std::fill(v.begin(), v.end(), INF);
+        for (int i=1; i<=rows; ++i) {
+            const auto* row = matrix[i-1];
+            for (int j=1; j<=cols; ++j)
+                if (!is_forbidden(row[j-1]) && static_cast<P>(row[j-1]) < v[j]) {
+                    v[j] = row[j-1];
+                    p[j] = i;
+                }
+        }
+        
+        // backwards, as LAPJV does, a row keeps the cheapest col of those it is minimal on
+        for (int j=cols; j>=1; --j) {
+            if (v[j] == INF)
+                throw std::runtime_error("No feasible assignment: a column has no allowed row");
+            int i = p[j];
+            if (held[i] == 0) {
+                x[i] = j;
+                held[i] = 1;
+            }
+            else {
+                held[i] = 2;
+                if (v[j] < v[x[i]]) {
+                    p[x[i]] = 0;
+                    x[i] = j;
+                }
+                else {
+                    p[j] = 0;
+                }
+            }
+        }
+        
+        // reduction transfer
+        for (int i=1; i<=rows; ++i) {
+            if (held[i] == 0) {
+                free.push_back(i);
+            }
+            else if (held[i] == 1) {
+                const auto* row = matrix[i-1];
+                int j1 = x[i];
+                P mu = INF;
+                for (int j=1; j<=cols; ++j)
+                    if (j != j1 && !is_forbidden(row[j-1]))
+                        mu = std::min(mu, static_cast<P>(row[j-1]) - v[j]);
+                if (mu != INF)
+                    v[j1] = static_cast<P>(row[j1-1]) - mu;
+            }
+        }
+    }
+    else {
+        // row reduction, v stays 0
+        std::fill(v.begin(), v.end(), 0);
+        for (int i=1; i<=rows; ++i) {
+            const auto* row = matrix[i-1];
+            int j1 = 0;
+            for (int j=1; j<=cols; ++j)
+                if (!is_forbidden(row[j-1]) && (j1 == 0 || row[j-1] < row[j1-1]))
+                    j1 = j;
+            if (j1 == 0)
+                throw std::runtime_error("No feasible assignment: a row has no allowed column");
+            if (p[j1] == 0) {
+                p[j1] = i;
+                x[i] = j1;
+            }
+            else {
+                free.push_back(i);
+            }
+        }
+    }
+    
+    /* augmenting row reduction, twice; cols only ever get assigned, so free cols keep 
+     * v = 0.  A pushed out row carries on at once only while v really drops, at most
+     * cols times a pass, so rounding or long chains cannot keep it going: the rows
+     * left over are the shortest paths' to assign. */
+    for (int pass=0; pass<2; ++pass) {
+        std::size_t k = 0;
+        std::size_t pending = free.size();
+        std::size_t left = 0;
+        int budget = cols;
+        
+        while (k < pending) {
+            int i = free[k++];
+            const auto* row = matrix[i-1];
+            
+            // cheapest and second cheapest reduced cost C(i,j) - v(j)
+            P umin = INF, usub = INF;
+            int j1 = 0, j2 = 0;
+            for (int j=1; j<=cols; ++j) {
+                if (is_forbidden(row[j-1]))
+                    continue;
+                P h = static_cast<P>(row[j-1]) - v[j];
+                if (h < usub) {
+                    if (j1 != 0 && h >= umin) {
+                        usub = h;
+                        j2 = j;
+                    }
+                    else {
+                        usub = umin;
+                        j2 = j1;
+                        umin = h;
+                        j1 = j;
+                    }
+                }
+            }
+            if (j1 == 0)
+                throw std::runtime_error("No feasible assignment: a row has no allowed column");
+            
+            int i0 = p[j1];
+            bool lowered = false;
+            if (j2 == 0) {
+                // a single allowed col, taken: leave the row to the shortest paths
+                if (i0 != 0) {
+                    free[left++] = i;
+                    continue;
+                }
+            }
+            else if (umin < usub) {
+                P lower = v[j1] - (usub - umin);
+                lowered = lower < v[j1] && budget-- > 0;
+                v[j1] = lower;
+            }
+            else if (i0 != 0) {
+                // a tie, the second col may be free
+                j1 = j2;
+                i0 = p[j2];
+            }
+            
+            p[j1] = i;
+            x[i] = j1;
+            if (i0 != 0) {
+                x[i0] = 0;
+                if (lowered)
+                    free[--k] = i0; // carry on with the row pushed out
+                else
+                    free[left++] = i0;
+            }
+        }
+        free.resize(left);
+    }
+    
+    /* row potentials: the reduced cost of the assigned col, else the row minimum, and
+     * like step 2 a free row takes a free col it is tight on, which catches most of 
+     * what ties leave to the shortest paths */
+    for (int i=1; i<=rows; ++i) {
+        const auto* row = matrix[i-1];
+        if (x[i] != 0) {
+            u[i] = static_cast<P>(row[x[i]-1]) - v[x[i]];
+            continue;
+        }
+        P best = INF;
+        int j1 = 0;
+        for (int j=1; j<=cols; ++j)
+            if (!is_forbidden(row[j-1])) {
+                P h = static_cast<P>(row[j-1]) - v[j];
+                if (h < best || (h == best && p[j1] != 0 && p[j] == 0)) {
+                    best = h;
+                    j1 = j;
+                }
+            }
+        u[i] = best;
+        if (j1 != 0 && p[j1] == 0) {
+            p[j1] = i;
+            x[i] = j1;
+        }
+    }
+    
+    std::size_t left = 0;
+    for (int i: free)
+        if (x[i] == 0)
+            free[left++] = i;
+    free.resize(left);
+    
+    return rows - free.size();
+}
+
+/* Returns false when the budget ran out with some rows still free, which keep -1 */
+template<typename Costs, typename P>
+bool shortest_augmenting_path(Costs& matrix,
+                              PathBuffers<P>& buf,
+                              std::vector<int>& StarInRow,
+                              std::vector<int>& StarInCol,
+                              SolveStats* stats = nullptr,
+                              const StopCondition& stop = StopCondition(),
+                              const Budget& budget = Budget())
+{
+    int cols = matrix.cols();
+    bool complete = true;
+    
+    {
+        MUNKRES_STAT(std::uint64_t ignored = 0;
+                     StatTimer timer (stats ? stats->init_ticks : ignored);)
+        std::size_t assigned = initial_assignment(matrix, buf);
+        if (stats)
+            stats->add_init(assigned);
+    }
+    
+    std::uint64_t inserted = 0;
+    for (int i: buf.free) {
+        stop.check();
+        if (budget.spent(inserted++)) {
+            complete = false;
+            break;
+        }
+        int length = augment_row(matrix, buf, i);
+        if (length < 0)
+            throw std::runtime_error("No feasible assignment: the allowed pairs cannot match every row");
+        if (stats)
+            stats->add_path(length);
+    }
+    
+    auto& p = buf.p;
+    for (int j=1; j<=cols; ++j)
+        if (p[j] != 0) {
+            StarInRow[p[j]-1] = j-1;
+            StarInCol[j-1] = p[j]-1;
+        }
+    
+    return complete;
+}
+
+/* Value type of the auction engine.  Integral costs are bid in 64 bits after scaling 
+ * them by n+1, floating point costs in double as they are */
+template<typename T, bool = std::is_floating_point<T>::value>
+struct auction_value {
+    using type = std::int64_t;
+};
+
+template<typename T>
+struct auction_value<T, true> {
+    using type = double;
+};
+
+/* State of the auction.  Rows 0..rows-1 are the rows of the matrix, the rows after 
+ * them up to cols are virtual rows of zero cost that make a wide problem square. */
+template<typename A>
+struct AuctionBuffers {
+    std::vector<A> price;   // per col
+    std::vector<int> owner; // row holding col j, -1 if none
+    std::vector<int> object; // col held by row i, -1 if none
+    std::vector<int> bidders; // rows without a col
+    std::vector<int> next;
+    
+    // one round of Jacobi bidding: the bids, and per col the best bid so far
+    std::vector<int> bid_col;
+    std::vector<A> bid_price;
+    std::vector<int> winner;
+    
+    void reset(std::size_t cols)
+    {
+        price.assign(cols, 0);
+        owner.assign(cols, -1);
+        object.assign(cols, -1);
+        winner.assign(cols, -1);
+        bidders.reserve(cols);
+        next.reserve(cols);
+        bid_col.resize(cols);
+        bid_price.resize(cols);
+    }
+};
+
+/* Bid of row i: the col j1 of smallest C(i,j) + p(j), whose price is raised until it is 
+ * eps above the second best col.  scale multiplies the costs, virtual rows cost 0. */
+template<typename T, typename A>
+void auction_bid(const MatrixView<T>& matrix,
+                 const std::vector<A>& price,
+                 int i,
+                 A scale,
+                 A eps,
+                 int& col,
+                 A& bid)
+{
+    const A INF = std::numeric_limits<A>::max();
+    int cols = price.size();
+    const T* row = i < static_cast<int>(matrix.rows()) ? matrix[i] : nullptr;
+    
+    A best = INF;
+    A second = INF;
+    col = 0;
+    for (int j=0; j<cols; ++j) {
+        A val = (row ? static_cast<A>(row[j]) * scale : A(0)) + price[j];
+        if (val < best) {
+            second = best;
+            best = val;
+            col = j;
+        }
+        else if (val < second) {
+            second = val;
+        }
+    }
+    
+    if (second == INF) // a single col
+        second = best;
+    bid = price[col] + (second - best) + eps;
+}
+
+/* One eps phase.  Without a pool it is Gauss-Seidel: one row bids at a time against 
+ * the latest prices.  With a pool every free row bids at once (Jacobi), the bids are
+ * computed in parallel, and each col goes to its highest bidder. */
+template<typename T, typename A>
+void auction_phase(const MatrixView<T>& matrix,
+                   AuctionBuffers<A>& buf,
+                   A scale,
+                   A eps,
+                   ThreadPool* pool,
+                   const StopCondition& stop)
+{
+    int cols = buf.price.size();
+    
+    std::fill(buf.owner.begin(), buf.owner.end(), -1);
+    std::fill(buf.object.begin(), buf.object.end(), -1);
+    buf.bidders.clear();
+    for (int i=cols-1; i>=0; --i)
+        buf.bidders.push_back(i);
+    
+    if (pool == nullptr || pool->size() == 1) {
+        // a serial round is cols bids
+        for (int bids = 1; !buf.bidders.empty(); ++bids) {
+            if (bids % cols == 0)
+                stop.check();
+            int i = buf.bidders.back();
+            buf.bidders.pop_back();
+            
+            int j;
+            A bid;
+            auction_bid(matrix, buf.price, i, scale, eps, j, bid);
+            
+            int prev = buf.owner[j];
+            if (prev != -1) {
+                buf.object[prev] = -1;
+                buf.bidders.push_back(prev);
+            }
+            buf.owner[j] = i;
+            buf.object[i] = j;
+            buf.price[j] = bid;
+        }
+        return;
+    }
+    
+    while (!buf.bidders.empty()) {
+        stop.check();
+        std::size_t n = buf.bidders.size();
+        
+        parallel_for(pool, n, n * cols, [&](std::size_t b, std::size_t e) {
+            for (std::size_t k=b; k<e; ++k)
+                auction_bid(matrix, buf.price, buf.bidders[k], scale, eps, buf.bid_col[k], buf.bid_price[k]);
+        });
+        
+        for (std::size_t k=0; k<n; ++k) {
+            int j = buf.bid_col[k];
+            if (buf.winner[j] == -1 || buf.bid_price[k] > buf.bid_price[buf.winner[j]])
+                buf.winner[j] = k;
+        }
+        
+        // outbid rows and the previous owners of the cols won bid again
+        buf.next.clear();
+        for (std::size_t k=0; k<n; ++k) {
+            int j = buf.bid_col[k];
+            if (buf.winner[j] != static_cast<int>(k)) {
+                buf.next.push_back(buf.bidders[k]);
+                continue;
+            }
+            
+            int prev = buf.owner[j];
+            if (prev != -1) {
+                buf.object[prev] = -1;
+                buf.next.push_back(prev);
+            }
+            buf.owner[j] = buf.bidders[k];
+            buf.object[buf.bidders[k]] = j;
+            buf.price[j] = buf.bid_price[k];
+        }
+        
+        for (std::size_t k=0; k<n; ++k)
+            buf.winner[buf.bid_col[k]] = -1;
+        
+        buf.bidders.swap(buf.next);
+    }
+}
+
+/* Bertsekas auction with eps scaling, rows <= cols.  Each phase assigns every row 
+ * with bids that keep all rows within eps of their best col, the prices carrying over
+ * to the next phase with eps divided by 5.  Integral costs are scaled by n+1, so the 
+ * last phase at eps = 1 leaves the assignment within n/(n+1) < 1 of the optimum, i.e.
+ * optimal.  Floating point costs stop at an eps putting the total within the zero
+ * tolerance, or 1e-9 of the cost range, of the optimum. */
+template<typename T, typename A>
+void auction_solve(const MatrixView<T>& matrix,
+                   AuctionBuffers<A>& buf,
+                   T tolerance,
+                   std::vector<int>& StarInRow,
+                   std::vector<int>& StarInCol,
+                   ThreadPool* pool,
+                   const StopCondition& stop = StopCondition())
+{
+    std::size_t rows = matrix.rows();
+    std::size_t cols = matrix.cols();
+    buf.reset(cols);
+    if (rows == 0)
+        return;
+    
+    // the virtual rows of a wide problem cost 0
+    T lo = rows < cols ? T(0) : matrix[0][0];
+    T hi = lo;
+    for (std::size_t r=0; r<rows; ++r)
+        for (std::size_t c=0; c<cols; ++c) {
+            lo = std::min(lo, matrix[r][c]);
+            hi = std::max(hi, matrix[r][c]);
+        }
+    
+    A scale = 1;
+    A eps_final = 1;
+    if (std::is_floating_point<T>::value) {
+        double range = double(hi) - double(lo);
+        double largest = std::max(std::abs(double(hi)), std::abs(double(lo)));
+        eps_final = static_cast<A>(std::max(double(tolerance), range * 1e-9) / cols);
+        // below the rounding of the prices a bid would not raise them
+        eps_final = std::max(eps_final, static_cast<A>((range + largest) * 16 * std::numeric_limits<double>::epsilon()));
+        if (!(eps_final > 0))
+            eps_final = 1; // all costs equal
+    }
+    else {
+        scale = static_cast<A>(cols + 1);
+        long double largest = std::max(std::abs(static_cast<long double>(hi)), 
+                                       std::abs(static_cast<long double>(lo)));
+        if (largest * scale * 8 > static_cast<long double>(std::numeric_limits<A>::max()))
+            throw std::runtime_error("Costs too large for the auction engine");
+    }
+    
+    A range = (static_cast<A>(hi) - static_cast<A>(lo)) * scale;
+    A eps = std::max(eps_final, range / 4);
+    for (;;) {
+        auction_phase(matrix, buf, scale, eps, pool, stop);
+        if (eps <= eps_final)
+            break;
+        eps = std::max(eps_final, eps / 5);
+    }
+    
+    for (std::size_t r=0; r<rows; ++r) {
+        StarInRow[r] = buf.object[r];
+        StarInCol[buf.object[r]] = r;
+    }
+}
+
+/* Print the assignment as a 0/1 mask, one row per line */
+inline void print_assignment(std::ostream& os,
+                             const std::vector<int>& StarInRow,
+                             std::size_t cols)
+{
+    for (auto star: StarInRow) {
+        os << " ";
+        for (std::size_t c=0; c<cols; ++c)
+            os << (static_cast<int>(c) == star) << " ";
+        os << "\n";
+    }
+}
+
+
+/* Available engines. Munkres walks the classic step1-step6 state machine, 
+ * JonkerVolgenant runs the O(n^3) shortest augmenting path solver, Auction the
+ * eps scaling auction, whose bids spread over the thread pool.  All return the same
+ * optimal cost, the auction within a tiny tolerance for floating point costs.  A
+ * problem with forbidden pairs, see forbidden(), is never given to the auction: it 
+ * runs the shortest path engine instead.  Infeasible problems throw std::runtime_error. */
+enum class Algorithm {
+    Munkres,
+    JonkerVolgenant,
+    Auction
+};
+
+/* Result of a solve: the column assigned to each row (-1 for none) and the total cost,
+ * summed in the accumulator type of the costs */
+template<typename T>
+struct Solution {
+    std::vector<int> assignment;
+    typename accumulator<T>::type cost = 0;
+};
+
+/* Result of a solve under a Budget.  bound comes from the dual potentials the engine
+ * had reached: no assignment costs less when minimizing, or more when maximizing, up 
+ * to the zero tolerance of floating point costs.  optimal tells whether the solve 
+ * finished, in which case bound is the cost.  complete tells whether every row got a
+ * col, which a solve cut short may miss where forbidden pairs block its completion.
+ * gap() is how far from the optimum the cost may be, unbounded (infinity, or the 
+ * largest value of integral costs) when the assignment is incomplete. */
+template<typename T>
+struct BoundedSolution : Solution<T> {
+    using A = typename accumulator<T>::type;
+    A bound = 0;
+    bool optimal = true;
+    bool complete = true;
+    
+    A gap() const
+    {
+        if (!complete)
+            return std::numeric_limits<A>::has_infinity ? std::numeric_limits<A>::infinity()
+                                                        : std::numeric_limits<A>::max();
+        return this->cost > bound ? this->cost - bound : bound - this->cost;
+    }
+};
+
+/* Signed type the dual bound of costs T is summed in */
+template<typename T>
+using dual_sum = typename std::conditional<std::is_floating_point<T>::value,
+                                           typename accumulator<T>::type, std::int64_t>::type;
+
+/* Every buffer a solve needs. Loading a problem only reassigns the vectors, so a
+ * workspace reused for problems of similar size stops allocating. */
+template<typename T>
+struct Workspace {
+    std::size_t rows = 0; // shape of the problem as given
+    std::size_t cols = 0;
+    
+    /* The engines read the costs through costs, read-only.  It always has rows <= cols:
+     * a problem with more rows than cols is copied transposed into matrix, so the 
+     * engines only ever iterate over the smaller dimension.  Other problems given as a
+     * view are read in place, and containers are copied into matrix. */
+    MatrixView<T> costs;
+    Matrix<T> matrix;
+    bool transposed = false;
+    bool maximize = false; // costs holds the flipped costs, see flip_cost
+    
+    // row and col offsets of the reduced costs, in the potential type like jv
+    std::vector<typename potential<T>::type> u;
+    std::vector<typename potential<T>::type> v;
+    
+    /* Star and prime index arrays, they replace the masked matrix M.  
+     * StarInRow(i)=j and StarInCol(j)=i if C(i,j) is a starred zero,  
+     * PrimeInRow(i)=j if C(i,j) is a primed zero, -1 otherwise. */
+    std::vector<int> StarInRow;
+    std::vector<int> StarInCol;
+    std::vector<int> PrimeInRow;
+    
+    /* We also define two sets RowCover and ColCover that are used to "cover" 
+     *the rows and columns of the cost matrix C, one bit per line */
+    CoverSet RowCover;
+    CoverSet ColCover;
+    
+    // slack of the uncovered rows, shared by steps 4 and 6
+    ZeroSearch<typename potential<T>::type> search;
+    
+    // Array for the augmenting path algorithm, which alternates primes and stars
+    // and so can visit up to 2*rows cells
+    Matrix<int> path;
+    
+    // potentials of the shortest path engine, which may go negative
+    PathBuffers<typename potential<T>::type> jv;
+    
+    // prices and bids of the auction engine
+    AuctionBuffers<typename auction_value<T>::type> auction;
+    
+    // instrumentation of the last solve, see MUNKRES_STATS
+    SolveStats stats;
+    
+    /* whether the last solve finished, else the dual bound it reached, in the sense of
+     * costs, and whether every row still got a col */
+    bool optimal = true;
+    bool complete = true;
+    dual_sum<T> bound = 0;
+    
+    void reset()
+    {
+        std::size_t k = costs.rows();
+        std::size_t m = costs.cols();
+        
+        u.assign(k, 0);
+        v.assign(m, 0);
+        StarInRow.reserve(m); // the transposed result has one entry per col
+        StarInRow.assign(k, -1);
+        StarInCol.assign(m, -1);
+        PrimeInRow.assign(k, -1);
+        RowCover.assign(k);
+        ColCover.assign(m);
+        search.reset(k);
+        path.assign(2*k, 2, 0);
+    }
+    
+    // make costs a private copy, for callers that go on to edit it
+    void own()
+    {
+        if (costs.data() == matrix.data())
+            return;
+        matrix.assign(costs.rows(), costs.cols());
+        for (std::size_t r=0; r<costs.rows(); ++r)
+            std::copy(costs[r], costs[r] + costs.cols(), matrix[r]);
+        costs = matrix;
+    }
+    
+    // memory held by the buffers, whether in use or only reserved
+    std::size_t bytes() const
+    {
+        using P = typename potential<T>::type;
+        return matrix.rows() * matrix.stride() * sizeof(T)
+             + (u.capacity() + v.capacity() + search.Slack.capacity()) * sizeof(P)
+             + RowCover.capacity_bytes() + ColCover.capacity_bytes()
+             + (StarInRow.capacity() + StarInCol.capacity() + PrimeInRow.capacity()
+                + search.SlackCol.capacity()
+                + search.Zeros.capacity() + path.rows() * path.stride()
+                + jv.p.capacity() + jv.way.capacity() + jv.free.capacity()) * sizeof(int)
+             + (jv.u.capacity() + jv.v.capacity() + jv.minv.capacity()) * sizeof(P)
+             + jv.used.capacity();
+    }
+};
+
+/* Sense of the objective.  A maximized problem is solved as the minimization of its
+ * flipped costs, see flip_cost, and its cost reported in the original sense. */
+enum class Objective {
+    Minimize,
+    Maximize
+};
+
+/* Smallest cost flip_cost() can map: for signed integral types -min overflows and
+ * -(-max) would read as forbidden */
+template<typename T>
+constexpr T flippable_min()
+{
+    return std::is_integral<T>::value && std::is_signed<T>::value ? T(-(std::numeric_limits<T>::max() - 1))
+                                                                  : std::numeric_limits<T>::lowest();
+}
+
+/* Order reversing map of the costs, its own inverse: -c, or max - 1 - c for unsigned
+ * types so that they stay representable and clear of the sentinel.  Forbidden cells 
+ * stay forbidden, and a cost below flippable_min() throws. */
+template<typename T>
+inline T flip_cost(T c)
+{
+    if (c < flippable_min<T>())
+        throw std::runtime_error("Cost too negative to maximize");
+    return is_forbidden(c) ? c : std::is_unsigned<T>::value ? T(std::numeric_limits<T>::max() - 1 - c) : T(-c);
+}
+
+/* Copies the costs of a problem into ws.matrix, in the workspace orientation, doing in
+ * the same pass what would otherwise take passes of their own: the sign check when 
+ * negatives are not allowed, the flip of a maximized problem and the largest magnitude
+ * the automatic zero tolerance is derived from. */
+template<typename T>
+class CostCopier {
+public:
+    CostCopier(Workspace<T>& ws, bool allow_negatives, bool need_largest)
+        : ws_ (ws), check_ {!std::is_unsigned<T>::value && !allow_negatives}, 
+          need_largest_ {need_largest}
+    {
+        if (ws.transposed)
+            ws.matrix.assign(ws.cols, ws.rows, T(0));
+        else
+            ws.matrix.assign(ws.rows, ws.cols, T(0));
+    }
+    
+    void operator()(std::size_t r, std::size_t c, T n)
+    {
+        if (check_ && n < 0)
+            throw std::runtime_error("Only non-negative values allowed");
+        if (need_largest_ && !is_forbidden(n))
+            largest_ = std::max(largest_, n < 0 ? T(-n) : n);
+        (ws_.transposed ? ws_.matrix[c][r] : ws_.matrix[r][c]) = ws_.maximize ? flip_cost(n) : n;
+    }
+    
+    /* Points the costs at the copy and sets up the rest of the workspace */
+    void finish(T tolerance)
+    {
+        ws_.costs = ws_.matrix;
+        ws_.reset();
+        ws_.search.tolerance = need_largest_ ? auto_tolerance(ws_.costs, largest_)
+                                             : zero_tolerance(ws_.costs, tolerance, std::is_floating_point<T>());
+    }
+    
+private:
+    Workspace<T>& ws_;
+    bool check_;
+    bool need_largest_;
+    T largest_ = 0;
+};
+
+/* Copy the problem into the workspace at its native shape, no dummy rows/columns are
+ * added.  A problem taller than wide is copied transposed so that rows <= cols. 
+ * tolerance only matters for floating point costs, negative meaning automatic.
+ * A maximized problem is stored with flipped costs. */
+template<template <typename, typename...> class Container,
+         typename T,
+         typename... Args>
+void load_problem(Workspace<T>& ws,
+                  const Container<Container<T,Args...>>& original,
+                  bool allow_negatives,
+                  T tolerance = T(-1),
+                  Objective objective = Objective::Minimize)
+{
+    ws.rows = original.size();
+    ws.cols = original.begin()->size();
+    ws.transposed = ws.rows > ws.cols;
+    ws.maximize = objective == Objective::Maximize;
+    
+    bool need_largest = std::is_floating_point<T>::value && tolerance < 0;
+    CostCopier<T> copy (ws, allow_negatives, need_largest);
+    
+    std::size_t r = 0;
+    if (!ws.transposed && !ws.maximize && !need_largest && 
+        (allow_negatives || std::is_unsigned<T>::value)) {
+        // nothing to do on the way, copy whole rows
+        for (auto& vec: original)
+            std::copy(vec.begin(), vec.end(), ws.matrix[r++]);
+    }
+    else {
+        for (auto& vec: original) {
+            std::size_t c = 0;
+            for (auto& n: vec)
+                copy(r, c++, n);
+            ++r;
+        }
+    }
+    
+    copy.finish(tolerance);
+}
+
+/* A view is solved in place unless it must be transposed or flipped */
+template<typename T>
+void load_problem(Workspace<T>& ws,
+                  const MatrixView<T>& original,
+                  bool allow_negatives,
+                  T tolerance = T(-1),
+                  Objective objective = Objective::Minimize)
+{
+    ws.rows = original.rows();
+    ws.cols = original.cols();
+    ws.transposed = ws.rows > ws.cols;
+    ws.maximize = objective == Objective::Maximize;
+    
+    if (ws.transposed || ws.maximize) {
+        CostCopier<T> copy (ws, allow_negatives, std::is_floating_point<T>::value && tolerance < 0);
+        for (std::size_t r=0; r<ws.rows; ++r)
+            for (std::size_t c=0; c<ws.cols; ++c)
+                copy(r, c, original[r][c]);
+        copy.finish(tolerance);
+        return;
+    }
+    
+    ws.costs = original;
+    
+    if (!std::is_unsigned<T>::value) {
+        handle_negatives(ws.costs, allow_negatives);
+    }
+    
+    ws.reset();
+    ws.search.tolerance = zero_tolerance(ws.costs, tolerance, std::is_floating_point<T>());
+}
+
+template<typename T>
+void load_problem(Workspace<T>& ws,
+                  const Matrix<T>& original,
+                  bool allow_negatives,
+                  T tolerance = T(-1),
+                  Objective objective = Objective::Minimize)
+{
+    load_problem(ws, MatrixView<T>(original), allow_negatives, tolerance, objective);
+}
+
+/* Whether any pair of the problem is forbidden */
+template<typename T>
+bool has_forbidden(const MatrixView<T>& matrix)
+{
+    for (std::size_t r=0; r<matrix.rows(); ++r)
+        if (std::find_if(matrix[r], matrix[r] + matrix.cols(), is_forbidden<T>) != matrix[r] + matrix.cols())
+            return true;
+    return false;
+}
+
+/* Smallest and largest allowed cost, false when every pair is forbidden */
+template<typename T>
+bool cost_range(const MatrixView<T>& matrix, T& low, T& high)
+{
+    bool any = false;
+    for (std::size_t r=0; r<matrix.rows(); ++r)
+        for (const T* c = matrix[r]; c != matrix[r] + matrix.cols(); ++c)
+            if (!is_forbidden(*c)) {
+                low = any ? std::min(low, *c) : *c;
+                high = any ? std::max(high, *c) : *c;
+                any = true;
+            }
+    return any;
+}
+
+/* Largest magnitude the integral offset arithmetic of a solve can reach.  Every step 6
+ * raises a dual bound by at least its shift, and the bound never passes the optimum, so
+ * the shifts of a whole solve add up to at most rows*range, range being the spread of
+ * the allowed costs.  Each offset, partial difference C(r,c) - u(r) and reduced cost 
+ * then stays within max|C| + (rows+1)*range.  Worked out in long double, which holds
+ * every 64 bit cost, so that the bound itself cannot overflow.  Only 64 bit costs need
+ * it: the int64_t offsets of narrower costs have room to spare. */
+template<typename T>
+long double offset_span(const MatrixView<T>& matrix, T low, T high)
+{
+    long double lo = low, hi = high;
+    return std::max(std::abs(lo), std::abs(hi)) + (matrix.rows() + 1) * (hi - lo);
+}
+
+/* Whether values of magnitude up to span can be held in T */
+template<typename T>
+bool fits(long double span)
+{
+    return span < static_cast<long double>(std::numeric_limits<T>::max());
+}
+
+/* Stars and offsets of a square problem from initial_assignment(), in place of steps 1
+ * and 2: the rows it assigns are starred zeros, and only the rows still free need the
+ * steps 4 to 6.  Its potentials are valid offsets, the reduced costs stay >= 0. */
+template<typename T>
+void initial_stars(Workspace<T>& ws)
+{
+    auto& jv = ws.jv;
+    jv.reset(ws.costs.rows(), ws.costs.cols());
+    {
+        MUNKRES_STAT(StatTimer timer (ws.stats.init_ticks);)
+        ws.stats.add_init(initial_assignment(ws.costs, jv));
+    }
+    
+    std::copy(jv.u.begin() + 1, jv.u.end(), ws.u.begin());
+    std::copy(jv.v.begin() + 1, jv.v.end(), ws.v.begin());
+    for (std::size_t c=0; c<ws.costs.cols(); ++c)
+        if (jv.p[c+1] != 0) {
+            ws.StarInRow[jv.p[c+1]-1] = c;
+            ws.StarInCol[c] = jv.p[c+1]-1;
+        }
+}
+
+/* The dual bound sum u + sum v of potentials feasible for the costs, from index first
+ * on.  When cols outnumber rows a col may stay free, so only v(j) <= 0 bounds and a 
+ * positive one counts as 0.  The potentials are signed, int64_t for integral costs,
+ * and summed as they are. */
+template<typename S, typename P>
+S dual_bound(const std::vector<P>& u, const std::vector<P>& v, std::size_t first, bool square)
+{
+    static_assert(std::is_signed<P>::value, "potentials may go negative");
+    S res = 0;
+    for (std::size_t i=first; i<u.size(); ++i)
+        res += static_cast<S>(u[i]);
+    for (std::size_t j=first; j<v.size(); ++j) {
+        S val = static_cast<S>(v[j]);
+        res += square ? val : std::min(val, S(0));
+    }
+    return res;
+}
+
+/* The budget ran out with the potentials u, v (from index first on, like dual_bound):
+ * give every row left without a star its cheapest allowed free col, in row order, and
+ * record the dual bound.  A row whose free cols are all forbidden keeps -1, and the
+ * assignment is then incomplete: its cost is no upper bound of the optimum at all. */
+template<typename T, typename P>
+void finish_early(Workspace<T>& ws, const std::vector<P>& u, const std::vector<P>& v, std::size_t first)
+{
+    using S = dual_sum<T>;
+    const auto& matrix = ws.costs;
+    S bound = dual_bound<S>(u, v, first, matrix.rows() == matrix.cols());
+    
+    for (std::size_t r=0; r<matrix.rows(); ++r) {
+        if (ws.StarInRow[r] != -1)
+            continue;
+        int best = -1;
+        for (std::size_t c=0; c<matrix.cols(); ++c)
+            if (ws.StarInCol[c] == -1 && !is_forbidden(matrix[r][c]) &&
+                (best == -1 || matrix[r][c] < matrix[r][best]))
+                best = c;
+        if (best != -1) {
+            ws.StarInRow[r] = best;
+            ws.StarInCol[best] = r;
+        }
+    }
+    
+    S cost = 0;
+    ws.complete = true;
+    for (std::size_t r=0; r<matrix.rows(); ++r)
+        if (ws.StarInRow[r] != -1)
+            cost += matrix[r][ws.StarInRow[r]];
+        else
+            ws.complete = false;
+    
+    // within the zero tolerance a complete assignment may seem to beat the bound
+    ws.optimal = false;
+    ws.bound = ws.complete ? std::min(bound, cost) : bound;
+}
+
+/* Run the chosen engine on the loaded problem.  On return ws.StarInRow holds the 
+ * column assigned to each of the ws.rows rows, -1 where the row was left out. 
+ * If a thread pool is given, the O(n^2) reductions of the Munkres engine are split
+ * across its threads, and so are the bids of the auction.  stop is polled between 
+ * steps, see StopCondition, and so is the budget: when it runs out the stars are
+ * completed by finish_early(), ws.optimal is cleared and ws.bound set.  The initial
+ * assignment of either engine runs whatever the budget.  The auction has
+ * no dual bound to offer before it ends, so a limited budget runs the shortest path
+ * engine instead.  The offsets of both engines are held in int64_t for integral costs,
+ * and 64 bit costs whose offsets could overflow it (see offset_span) throw. */
+template<typename T>
+void solve_workspace(Workspace<T>& ws,
+                     Algorithm algorithm,
+                     ThreadPool* pool,
+                     const StopCondition& stop = StopCondition(),
+                     const Budget& budget = Budget())
+{
+    int path_row_0 = -1, path_col_0 = -1; //temporary to hold the smallest uncovered value
+    
+    /* Now Work The Steps */
+    bool done = false;
+    int step = 1;
+    
+    std::uint64_t iterations = 0;
+    bool square = ws.costs.rows() == ws.costs.cols();
+    ws.optimal = true;
+    ws.complete = true;
+    ws.bound = 0;
+    
+    MUNKRES_STAT(ws.stats.clear();
+                 StatTimer total (ws.stats.total_ticks);)
+    
+    // bidding cannot tell an infeasible problem from a slow one, so forbidden pairs
+    // go to the shortest path engine, which can
+    if (algorithm == Algorithm::Auction && (!budget.unlimited() || has_forbidden(ws.costs)))
+        algorithm = Algorithm::JonkerVolgenant;
+    
+    using P = typename potential<T>::type;
+    T low = 0, high = 0;
+    long double span = 0;
+    if (std::is_integral<T>::value && sizeof(T) >= sizeof(P) && 
+        algorithm != Algorithm::Auction && cost_range(ws.costs, low, high))
+        span = offset_span(ws.costs, low, high);
+    
+    // the shortest path engine stars the whole assignment at once
+    if (algorithm == Algorithm::JonkerVolgenant) {
+        if (!fits<P>(2*span))
+            throw std::runtime_error("Costs too large for the shortest path engine");
+        ws.jv.reset(ws.costs.rows(), ws.costs.cols());
+        if (!shortest_augmenting_path(ws.costs, ws.jv, ws.StarInRow, ws.StarInCol, &ws.stats, stop, budget))
+            finish_early(ws, ws.jv.u, ws.jv.v, 1);
+        step = 7;
+    }
+    else if (algorithm == Algorithm::Auction) {
+        auction_solve(ws.costs, ws.auction, static_cast<T>(ws.search.tolerance), 
+                      ws.StarInRow, ws.StarInCol, pool, stop);
+        step = 7;
+    }
+    else if (!fits<P>(span)) {
+        throw std::runtime_error("Costs too large for the Munkres engine");
+    }
+    else if (square) {
+        initial_stars(ws);
+        step = 3;
+    }
+    
+    while (!done) {
+        if (step != 7) {
+            stop.check();
+            // from step 3 on u and v are feasible and the stars a matching
+            if (step >= 3 && budget.spent(iterations++)) {
+                finish_early(ws, ws.u, ws.v, 0);
+                step = 7;
+            }
+        }
+        MUNKRES_STAT(int ran = step;
+                     std::uint64_t start = stat_ticks();)
+        
+        switch (step) {
+            case 1:
+                step1(ws.costs, ws.u, ws.v, pool, step);
+                break;
+            case 2:
+                step2(ws.costs, ws.u, ws.v, ws.StarInRow, ws.StarInCol, ws.search.tolerance, step);
+                MUNKRES_STAT(ws.stats.add_init(ws.costs.rows() - 
+                                               std::count(ws.StarInRow.begin(), ws.StarInRow.end(), -1));)
+                break;
+            case 3:
+                step3(ws.StarInCol, ws.ColCover, ws.costs.rows(), step);
+                break;
+            case 4:
+                step4(ws.costs, ws.u, ws.v, ws.StarInRow, ws.PrimeInRow, 
+                      ws.RowCover, ws.ColCover, ws.search,
+                      pool, ws.stats, path_row_0, path_col_0, step);
+                break;
+            case 5:
+                step5(ws.path, path_row_0, path_col_0, ws.StarInRow, ws.StarInCol, 
+                      ws.PrimeInRow, ws.RowCover, ws.ColCover, ws.stats, step);
+                ws.search.fresh = true;
+                break;
+            case 6:
+                step6(ws.u, ws.v, ws.RowCover, ws.ColCover, ws.search, pool, ws.stats, step);
+                break;
+            case 7:
+                // the cols of a transposed problem are the original rows
+                if (ws.transposed)
+                    ws.StarInRow.assign(ws.StarInCol.begin(), ws.StarInCol.end());
+                done = true;
+                break;
+            default:
+                done = true;
+                break;
+        }
+        
+        MUNKRES_STAT(if (ran >= 1 && ran <= 7) {
+                         ws.stats.runs[ran]++;
+                         ws.stats.ticks[ran] += stat_ticks() - start;
+                     })
+    }
+    
+    MUNKRES_STAT(ws.stats.peak_bytes = ws.bytes();)
+}
+
+/* Calculates the optimal cost of a solved workspace from the starred zeros of each 
+ * row, reading the costs it solved rather than walking the input again.  The cost of
+ * a maximized problem is given in the original sense. */
+template<typename T>
+typename accumulator<T>::type output_solution(const Workspace<T>& ws)
+{
+    typename accumulator<T>::type res = 0;
+    
+    for (std::size_t i=0; i<ws.rows; ++i) {
+        int star = ws.StarInRow[i];
+        if (star != -1) {
+            T cost = ws.transposed ? ws.costs[star][i] : ws.costs[i][star];
+            res += ws.maximize ? flip_cost(cost) : cost;
+        }
+    }
+    
+    return res;
+}
+
+/* Fill in the bound of a solution from its workspace, in the sense of the original costs.
+ * flip_cost maps the cost of every assignment of all the rows, and so the dual bound,
+ * to minus itself, or to rows*(max - 1) less itself for unsigned costs. */
+template<typename T>
+void output_bound(const Workspace<T>& ws, BoundedSolution<T>& solution)
+{
+    using A = typename accumulator<T>::type;
+    solution.optimal = ws.optimal;
+    solution.complete = ws.complete;
+    if (ws.optimal)
+        solution.bound = solution.cost;
+    else if (!ws.maximize)
+        solution.bound = std::is_unsigned<A>::value && ws.bound < 0 ? A(0) // the costs are non-negative
+                                                                     : static_cast<A>(ws.bound);
+    else if (std::is_unsigned<T>::value)
+        solution.bound = A(ws.costs.rows()) * A(std::numeric_limits<T>::max() - 1) - static_cast<A>(ws.bound);
+    else
+        solution.bound = static_cast<A>(-ws.bound);
+}
+
+/* Reusable solver. It owns the workspace and the solution of the last solve, and its 
+ * buffers only grow when a bigger problem than any before arrives, so repeated solves 
+ * of the same size do no heap allocation after the first one.  The reference returned
+ * by solve() stays valid until the next call. */
+template<typename T>
+class Solver {
+public:
+    explicit Solver(Algorithm algorithm = Algorithm::Munkres,
+                    bool allow_negatives = true,
+                    ThreadPool* pool = nullptr)
+        : algorithm_ {algorithm}, allow_negatives_ {allow_negatives}, pool_ {pool} {}
+    
+    /* zero test bound for floating point costs, negative (the default) derives it
+     * from the largest cost of each problem */
+    void set_tolerance(T tolerance) {tolerance_ = tolerance;}
+    
+    // maximize instead of minimize the total cost
+    void set_objective(Objective objective) {objective_ = objective;}
+    
+    // a view (or a Matrix) is solved in place, without copying the costs
+    const Solution<T>& solve(const MatrixView<T>& costs)
+    {
+        return run(costs);
+    }
+    
+    template<template <typename, typename...> class Container,
+             typename... Args>
+    const Solution<T>& solve(const Container<Container<T,Args...>>& costs)
+    {
+        return run(costs);
+    }
+    
+    /* Anytime solve: stop once the budget is spent and return the best assignment found
+     * so far, with a bound on how far it is from the optimum */
+    const BoundedSolution<T>& solve(const MatrixView<T>& costs, const Budget& budget)
+    {
+        return run(costs, budget);
+    }
+    
+    template<template <typename, typename...> class Container,
+             typename... Args>
+    const BoundedSolution<T>& solve(const Container<Container<T,Args...>>& costs, const Budget& budget)
+    {
+        return run(costs, budget);
+    }
+    
+    const BoundedSolution<T>& solution() const {return solution_;}
+    
+    // instrumentation of the last solve, all zero unless built with MUNKRES_STATS
+    const SolveStats& stats() const {return ws_.stats;}
+    
+private:
+    template<typename Problem>
+    const BoundedSolution<T>& run(const Problem& costs, const Budget& budget = Budget())
+    {
+        load_problem(ws_, costs, allow_negatives_, tolerance_, objective_);
+        solve_workspace(ws_, algorithm_, pool_, StopCondition(), budget);
+        
+        solution_.assignment.assign(ws_.StarInRow.begin(), ws_.StarInRow.end());
+        solution_.cost = output_solution(ws_);
+        output_bound(ws_, solution_);
+        return solution_;
+    }
+    
+    Workspace<T> ws_;
+    BoundedSolution<T> solution_;
+    Algorithm algorithm_;
+    bool allow_negatives_;
+    ThreadPool* pool_;
+    T tolerance_ = T(-1);
+    Objective objective_ = Objective::Minimize;
+};
+
+/* Solver for a problem that keeps changing a little, e.g. tracking where a few rows move
+ * between frames.  solve() runs the shortest path engine and keeps the assignment and
+ * its dual potentials.  set_row(), set_col() and set_cost() then edit the costs and 
+ * only drop the assignments and potentials they invalidate, and resolve() re-inserts 
+ * the rows left free.  k changed rows cost O(k*rows*cols) instead of a full solve.
+ * Rows and cols are those of the problem given to solve(). */
+template<typename T>
+class IncrementalSolver {
+    using P = typename potential<T>::type;
+    
+public:
+    explicit IncrementalSolver(bool allow_negatives = true)
+        : allow_negatives_ {allow_negatives} {}
+    
+    const Solution<T>& solve(const MatrixView<T>& costs)
+    {
+        load_problem(ws_, costs, allow_negatives_);
+        return full_solve();
+    }
+    
+    template<template <typename, typename...> class Container,
+             typename... Args>
+    const Solution<T>& solve(const Container<Container<T,Args...>>& costs)
+    {
+        load_problem(ws_, costs, allow_negatives_);
+        return full_solve();
+    }
+    
+    // replace the costs of row r, values holding one cost per col
+    template<typename Row>
+    void set_row(std::size_t r, const Row& values)
+    {
+        std::size_t c = 0;
+        for (auto& n: values)
+            at(r, c++) = checked(n);
+        
+        if (ws_.transposed)
+            repair_col(r);
+        else
+            repair_row(r);
+    }
+    
+    // replace the costs of col c, values holding one cost per row
+    template<typename Col>
+    void set_col(std::size_t c, const Col& values)
+    {
+        std::size_t r = 0;
+        for (auto& n: values)
+            at(r++, c) = checked(n);
+        
+        if (ws_.transposed)
+            repair_row(c);
+        else
+            repair_col(c);
+    }
+    
+    void set_cost(std::size_t r, std::size_t c, T value)
+    {
+        at(r, c) = checked(value);
+        
+        if (ws_.transposed)
+            std::swap(r, c);
+        
+        // a cheaper unassigned pair is the only change that keeps the assignment optimal
+        if (ws_.StarInRow[r] == static_cast<int>(c) || reduced(r, c) < 0)
+            repair_row(r);
+    }
+    
+    // restore optimality after the changes made since the last solve
+    const Solution<T>& resolve()
+    {
+        auto& p = ws_.jv.p;
+        for (std::size_t c=0; c<ws_.matrix.cols(); ++c)
+            p[c+1] = ws_.StarInCol[c] + 1;
+        
+        MUNKRES_STAT(ws_.stats.clear();)
+        for (std::size_t r=0; r<ws_.matrix.rows(); ++r)
+            if (ws_.StarInRow[r] == -1) {
+                int length = augment_row(ws_.costs, ws_.jv, r+1);
+                if (length < 0)
+                    throw std::runtime_error("No feasible assignment: the allowed pairs cannot match every row");
+                ws_.stats.add_path(length);
+            }
+        
+        std::fill(ws_.StarInRow.begin(), ws_.StarInRow.end(), -1);
+        std::fill(ws_.StarInCol.begin(), ws_.StarInCol.end(), -1);
+        for (std::size_t c=0; c<ws_.matrix.cols(); ++c)
+            if (p[c+1] != 0) {
+                ws_.StarInRow[p[c+1]-1] = c;
+                ws_.StarInCol[c] = p[c+1]-1;
+            }
+        
+        return finish();
+    }
+    
+    const Solution<T>& solution() const {return solution_;}
+    
+    // instrumentation of the last solve, all zero unless built with MUNKRES_STATS
+    const SolveStats& stats() const {return ws_.stats;}
+    
+private:
+    // cost (r, c) of the problem as given, the workspace may hold it transposed
+    T& at(std::size_t r, std::size_t c)
+    {
+        return ws_.transposed ? ws_.matrix[c][r] : ws_.matrix[r][c];
+    }
+    
+    T checked(T value) const
+    {
+        if (!allow_negatives_ && value < 0)
+            throw std::runtime_error("Only non-negative values allowed");
+        return value;
+    }
+    
+    // reduced cost in the workspace orientation, the largest P for a forbidden cell
+    P reduced(std::size_t r, std::size_t c) const
+    {
+        if (is_forbidden(ws_.matrix[r][c]))
+            return std::numeric_limits<P>::max();
+        return static_cast<P>(ws_.matrix[r][c]) - ws_.jv.u[r+1] - ws_.jv.v[c+1];
+    }
+    
+    const Solution<T>& full_solve()
+    {
+        ws_.own(); // the edits write into the costs
+        ws_.jv.reset(ws_.matrix.rows(), ws_.matrix.cols());
+        MUNKRES_STAT(ws_.stats.clear();)
+        shortest_augmenting_path(ws_.costs, ws_.jv, ws_.StarInRow, ws_.StarInCol, &ws_.stats);
+        return finish();
+    }
+    
+    const Solution<T>& finish()
+    {
+        const auto& stars = ws_.transposed ? ws_.StarInCol : ws_.StarInRow;
+        solution_.assignment.assign(stars.begin(), stars.end());
+        solution_.cost = 0;
+        for (std::size_t r=0; r<ws_.matrix.rows(); ++r)
+            solution_.cost += ws_.matrix[r][ws_.StarInRow[r]];
+        return solution_;
+    }
+    
+    /* Unassign row r.  With more cols than rows a free col must have v = 0, so the col
+     * it leaves is raised back to 0, which may push the potential of other rows down 
+     * and free them in turn. */
+    void free_row(std::size_t r)
+    {
+        int c = ws_.StarInRow[r];
+        if (c == -1)
+            return;
+        ws_.StarInRow[r] = -1;
+        ws_.StarInCol[c] = -1;
+        
+        if (ws_.matrix.rows() < ws_.matrix.cols())
+            raise_col(c);
+    }
+    
+    void raise_col(int c)
+    {
+        pending_.assign(1, c);
+        
+        while (!pending_.empty()) {
+            int col = pending_.back();
+            pending_.pop_back();
+            ws_.jv.v[col+1] = 0;
+            
+            for (std::size_t r=0; r<ws_.matrix.rows(); ++r)
+                if (reduced(r, col) < 0) {
+                    ws_.jv.u[r+1] = ws_.matrix[r][col];
+                    int star = ws_.StarInRow[r];
+                    if (star != -1) {
+                        ws_.StarInRow[r] = -1;
+                        ws_.StarInCol[star] = -1;
+                        pending_.push_back(star);
+                    }
+                }
+        }
+    }
+    
+    // row r changed: free it and lower its potential until its reduced costs are >= 0
+    void repair_row(std::size_t r)
+    {
+        free_row(r);
+        
+        P best = std::numeric_limits<P>::max();
+        for (std::size_t c=0; c<ws_.matrix.cols(); ++c)
+            if (!is_forbidden(ws_.matrix[r][c]))
+                best = std::min(best, static_cast<P>(ws_.matrix[r][c]) - ws_.jv.v[c+1]);
+        ws_.jv.u[r+1] = best;
+    }
+    
+    // col c changed: free the row holding it and make its reduced costs >= 0 again
+    void repair_col(std::size_t c)
+    {
+        int r = ws_.StarInCol[c];
+        
+        if (ws_.matrix.rows() < ws_.matrix.cols()) {
+            if (r != -1)
+                free_row(r);
+            else
+                raise_col(c);
+            return;
+        }
+        
+        // square: every col stays assigned, so v(c) is free to take the tightest value
+        if (r != -1) {
+            ws_.StarInRow[r] = -1;
+            ws_.StarInCol[c] = -1;
+        }
+        P best = std::numeric_limits<P>::max();
+        for (std::size_t i=0; i<ws_.matrix.rows(); ++i)
+            if (!is_forbidden(ws_.matrix[i][c]))
+                best = std::min(best, static_cast<P>(ws_.matrix[i][c]) - ws_.jv.u[i+1]);
+        ws_.jv.v[c+1] = best;
+    }
+    
+    Workspace<T> ws_;
+    Solution<T> solution_;
+    bool allow_negatives_;
+    std::vector<int> pending_; // cols raised back to 0 still to check
+};
+
+/* Load, solve and collect the solution of one problem given in any form load_problem
+ * accepts */
+template<typename Problem, typename T>
+Solution<T> solve_problem(const Problem& original,
+                          Objective objective,
+                          bool allow_negatives,
+                          Algorithm algorithm,
+                          ThreadPool* pool,
+                          T tolerance)
+{
+    // Work on a contiguous copy to preserve original matrix
+    // Didn't passed by value cause needed to access both
+    Workspace<T> ws;
+    load_problem(ws, original, allow_negatives, tolerance, objective);
+    solve_workspace(ws, algorithm, pool);
+    
+    Solution<T> solution;
+    solution.cost = output_solution(ws);
+    solution.assignment = std::move(ws.StarInRow);
+    return solution;
+}
+
+/* Main function of the algorithm. Returns the column assigned to each row and the 
+ * optimal cost, and does no I/O (see print_solution). If a thread pool is given, the
+ * O(n^2) reductions of the Munkres engine are split across its threads. 
+ * For floating point costs, tolerance bounds the reduced costs taken as zero; the 
+ * default derives it from the largest cost. */
+template<template <typename, typename...> class Container,
+         typename T,
+         typename... Args>
+typename std::enable_if<std::is_arithmetic<T>::value, Solution<T>>::type // Work only on integral or floating types
+hungarian(const Container<Container<T,Args...>>& original,
+          bool allow_negatives = true,
+          Algorithm algorithm = Algorithm::Munkres,
+          ThreadPool* pool = nullptr,
+          T tolerance = T(-1))
+{  
+    return solve_problem(original, Objective::Minimize, allow_negatives, algorithm, pool, tolerance);
+}
+
+/* Same on a view, e.g. of an mmapped buffer, which is solved without a copy unless it 
+ * has more rows than cols */
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, Solution<T>>::type
+hungarian(const MatrixView<T>& original,
+          bool allow_negatives = true,
+          Algorithm algorithm = Algorithm::Munkres,
+          ThreadPool* pool = nullptr,
+          T tolerance = T(-1))
+{
+    return solve_problem(original, Objective::Minimize, allow_negatives, algorithm, pool, tolerance);
+}
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, Solution<T>>::type
+hungarian(const Matrix<T>& original,
+          bool allow_negatives = true,
+          Algorithm algorithm = Algorithm::Munkres,
+          ThreadPool* pool = nullptr,
+          T tolerance = T(-1))
+{
+    return hungarian(MatrixView<T>(original), allow_negatives, algorithm, pool, tolerance);
+}
+
+/* The same with an explicit objective, hungarian(profits, Objective::Maximize) finds 
+ * the assignment of largest total.  The costs are flipped while they are copied into
+ * the workspace, so a maximized problem is read only once, and the cost returned is
+ * the maximal total itself. */
+template<template <typename, typename...> class Container,
+         typename T,
+         typename... Args>
+typename std::enable_if<std::is_arithmetic<T>::value, Solution<T>>::type
+hungarian(const Container<Container<T,Args...>>& original,
+          Objective objective,
+          bool allow_negatives = true,
+          Algorithm algorithm = Algorithm::Munkres,
+          ThreadPool* pool = nullptr,
+          T tolerance = T(-1))
+{  
+    return solve_problem(original, objective, allow_negatives, algorithm, pool, tolerance);
+}
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, Solution<T>>::type
+hungarian(const MatrixView<T>& original,
+          Objective objective,
+          bool allow_negatives = true,
+          Algorithm algorithm = Algorithm::Munkres,
+          ThreadPool* pool = nullptr,
+          T tolerance = T(-1))
+{
+    return solve_problem(original, objective, allow_negatives, algorithm, pool, tolerance);
+}
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, Solution<T>>::type
+hungarian(const Matrix<T>& original,
+          Objective objective,
+          bool allow_negatives = true,
+          Algorithm algorithm = Algorithm::Munkres,
+          ThreadPool* pool = nullptr,
+          T tolerance = T(-1))
+{
+    return solve_problem(MatrixView<T>(original), objective, allow_negatives, algorithm, pool, tolerance);
+}
+
+/* Anytime solve: whatever the engine reached when the budget ran out, completed 
+ * greedily, together with a bound on the optimum, see BoundedSolution.  E.g.
+ * hungarian(costs, Budget(std::chrono::milliseconds(5))) */
+template<typename Problem, typename T>
+BoundedSolution<T> solve_bounded(const Problem& original,
+                                 const Budget& budget,
+                                 Objective objective,
+                                 Algorithm algorithm)
+{
+    Workspace<T> ws;
+    load_problem(ws, original, true, T(-1), objective);
+    solve_workspace(ws, algorithm, nullptr, StopCondition(), budget);
+    
+    BoundedSolution<T> solution;
+    solution.cost = output_solution(ws);
+    output_bound(ws, solution);
+    solution.assignment = std::move(ws.StarInRow);
+    return solution;
+}
+
+template<template <typename, typename...> class Container,
+         typename T,
+         typename... Args>
+typename std::enable_if<std::is_arithmetic<T>::value, BoundedSolution<T>>::type
+hungarian(const Container<Container<T,Args...>>& original,
+          const Budget& budget,
+          Objective objective = Objective::Minimize,
+          Algorithm algorithm = Algorithm::Munkres)
+{
+    return solve_bounded<Container<Container<T,Args...>>, T>(original, budget, objective, algorithm);
+}
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, BoundedSolution<T>>::type
+hungarian(const MatrixView<T>& original,
+          const Budget& budget,
+          Objective objective = Objective::Minimize,
+          Algorithm algorithm = Algorithm::Munkres)
+{
+    return solve_bounded<MatrixView<T>, T>(original, budget, objective, algorithm);
+}
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, BoundedSolution<T>>::type
+hungarian(const Matrix<T>& original,
+          const Budget& budget,
+          Objective objective = Objective::Minimize,
+          Algorithm algorithm = Algorithm::Munkres)
+{
+    return solve_bounded<MatrixView<T>, T>(MatrixView<T>(original), budget, objective, algorithm);
+}
+
+/* Result of a fixed size solve, held by value */
+template<typename T, std::size_t N>
+struct FixedSolution {
+    std::array<int, N> assignment;
+    typename accumulator<T>::type cost;
+};
+
+/* Up to this size the fixed size solver is an exhaustive DP over the subsets of cols.
+ * Its 2^N * N work overtakes the shortest path solve above 4, about 150ns at 4x4. */
+constexpr std::size_t fixed_dp_limit = 4;
+
+/* DP over col subsets: best[mask] is the cheapest way to give the first popcount(mask) 
+ * rows the cols in mask, and pick[mask] the col the last of them took, none when the
+ * forbidden cells leave no way.  O(2^N * N) */
+template<typename T, std::size_t N>
+FixedSolution<T, N> fixed_solve(const std::array<std::array<T, N>, N>& costs, std::true_type)
+{
+    using A = typename accumulator<T>::type;
+    const std::uint8_t none = 0xff;
+    
+    std::array<A, (1u << N)> best;
+    std::array<std::uint8_t, (1u << N)> pick;
+    best[0] = 0;
+    pick[0] = 0;
+    
+    for (unsigned mask = 1; mask < (1u << N); ++mask) {
+        std::size_t row = popcount64(mask) - 1;
+        pick[mask] = none;
+        for (unsigned rest = mask; rest; rest &= rest - 1) {
+            int col = ctz64(rest);
+            unsigned prev = mask & ~(1u << col);
+            if (is_forbidden(costs[row][col]) || pick[prev] == none)
+                continue;
+            A val = best[prev] + costs[row][col];
+            if (pick[mask] == none || val < best[mask]) {
+                best[mask] = val;
+                pick[mask] = col;
+            }
+        }
+    }
+    
+    if (pick[(1u << N) - 1] == none)
+        throw std::runtime_error("No feasible assignment: the allowed pairs cannot match every row");
+    
+    FixedSolution<T, N> solution;
+    solution.cost = best[(1u << N) - 1];
+    unsigned mask = (1u << N) - 1;
+    for (std::size_t row = N; row-- > 0;) {
+        solution.assignment[row] = pick[mask];
+        mask &= ~(1u << pick[mask]);
+    }
+    return solution;
+}
+
+/* Larger sizes run the shortest augmenting path engine on std::array buffers, with 
+ * the visited cols as a bitmask, see augment_row */
+template<typename T, std::size_t N>
+FixedSolution<T, N> fixed_solve(const std::array<std::array<T, N>, N>& costs, std::false_type)
+{
+    using P = typename potential<T>::type;
+    const P INF = std::numeric_limits<P>::max();
+    
+    std::array<P, N+1> u {}, v {}, minv;
+    std::array<int, N+1> p {}, way {};
+    
+    for (int i=1; i<=static_cast<int>(N); ++i) {
+        p[0] = i;
+        int j0 = 0;
+        std::uint32_t used = 0;
+        minv.fill(INF);
+        
+        do {
+            used |= 1u << j0;
+            int i0 = p[j0];
+            int j1 = 0;
+            P delta = INF;
+            
+            for (int j=1; j<=static_cast<int>(N); ++j)
+                if (!(used >> j & 1)) {
+                    if (!is_forbidden(costs[i0-1][j-1])) {
+                        P cur = static_cast<P>(costs[i0-1][j-1]) - u[i0] - v[j];
+                        if (cur < minv[j]) {
+                            minv[j] = cur;
+                            way[j] = j0;
+                        }
+                    }
+                    if (minv[j] < delta) {
+                        delta = minv[j];
+                        j1 = j;
+                    }
+                }
+            
+            if (j1 == 0)
+                throw std::runtime_error("No feasible assignment: the allowed pairs cannot match every row");
+            
+            for (int j=0; j<=static_cast<int>(N); ++j)
+                if (used >> j & 1) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                }
+                else if (minv[j] != INF) {
+                    minv[j] -= delta; // unreached cols stay INF
+                }
+            
+            j0 = j1;
+        } while (p[j0] != 0);
+        
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    
+    FixedSolution<T, N> solution;
+    solution.cost = 0;
+    for (int j=1; j<=static_cast<int>(N); ++j)
+        solution.assignment[p[j]-1] = j-1;
+    for (std::size_t i=0; i<N; ++i)
+        solution.cost += costs[i][solution.assignment[i]];
+    return solution;
+}
+
+/* Square problems whose size is known at compile time, e.g. the 3x3 to 8x8 ones of an
+ * inner scoring loop.  Everything lives on the stack, the covers are bitmasks and 
+ * there is no step loop: up to fixed_dp_limit it is an exhaustive DP over subsets of
+ * cols, above it a shortest augmenting path solve on fixed arrays. */
+template<typename T, std::size_t N>
+typename std::enable_if<std::is_arithmetic<T>::value, FixedSolution<T, N>>::type
+hungarian(const std::array<std::array<T, N>, N>& costs)
+{
+    static_assert(N >= 1 && N <= 16, "fixed size problems are 1x1 to 16x16");
+    return fixed_solve(costs, std::integral_constant<bool, (N <= fixed_dp_limit)>());
+}
+
+/* A subproblem of Murty's partition: its optimal solution as shortest path state 
+ * (potentials and p, see PathBuffers), the rows forced to keep their col there and the 
+ * pairs forbidden */
+template<typename T, typename P>
+struct MurtyNode {
+    typename accumulator<T>::type cost = 0;
+    std::vector<P> u;
+    std::vector<P> v;
+    std::vector<int> p;
+    std::vector<int> forced;
+    std::vector<std::pair<int, int>> blocked;
+};
+
+/* Child t of a node: the free rows before free[t] keep their col, free[t] loses its 
+ * own.  The node's optimum stays dual feasible for it, so reinserting that one row 
+ * with a single augment_row is an O(n^2) solve instead of a full O(n^3) one.  Returns
+ * false when the constraints leave no assignment. */
+template<typename T, typename P>
+bool murty_child(const MatrixView<T>& matrix,
+                 const MurtyNode<T, P>& node,
+                 const std::vector<int>& free,
+                 const std::vector<int>& col_of,
+                 const std::vector<int>& rank,
+                 const Matrix<char>& blocked,
+                 std::size_t real_rows,
+                 std::size_t t,
+                 PathBuffers<P>& buf,
+                 MurtyNode<T, P>& child)
+{
+    int row = free[t];
+    int col = col_of[row];
+    
+    buf.u = node.u;
+    buf.v = node.v;
+    buf.p = node.p;
+    buf.p[col+1] = 0;
+    
+    // rank[c] orders the cols by the free row holding them, -1 for the forced ones
+    auto allowed = [&](int r, int c) {
+        return rank[c] >= static_cast<int>(t) && !blocked[r][c] && !(r == row && c == col);
+    };
+    if (augment_row(matrix, buf, row + 1, allowed) < 0)
+        return false;
+    
+    child.u = buf.u;
+    child.v = buf.v;
+    child.p = buf.p;
+    child.forced = node.forced;
+    child.forced.insert(child.forced.end(), free.begin(), free.begin() + t);
+    child.blocked = node.blocked;
+    child.blocked.emplace_back(row, col);
+    
+    child.cost = 0;
+    for (std::size_t j=1; j<child.p.size(); ++j)
+        if (static_cast<std::size_t>(child.p[j]) <= real_rows)
+            child.cost += matrix[child.p[j]-1][j-1];
+    return true;
+}
+
+/* The k cheapest assignments in increasing order of cost (fewer if the problem has
+ * fewer), by Murty's partitioning.  The optimum splits the remaining assignments into
+ * one subproblem per row; the cheapest open subproblem is the next best, and is split
+ * the same way.  Subproblems keep the potentials of their solve and every child is a
+ * warm started single row insertion, so each of the k steps costs O(n^3) rather than
+ * n full solves.  The children of a step are solved in parallel on the pool.
+ * Memory is O(k*n^2): every open subproblem keeps its O(n) solver state.  Forbidden
+ * cells are never assigned, and a problem they leave infeasible has no solutions. */
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, std::vector<Solution<T>>>::type
+k_best(const MatrixView<T>& costs,
+       std::size_t k,
+       ThreadPool* pool = nullptr)
+{
+    using P = typename potential<T>::type;
+    using Node = MurtyNode<T, P>;
+    
+    std::vector<Solution<T>> best;
+    if (k == 0 || costs.rows() == 0 || costs.cols() == 0)
+        return best;
+    
+    // square at the workspace orientation, rows past real_rows are virtual ones of cost 0
+    bool transposed = costs.rows() > costs.cols();
+    std::size_t real_rows = std::min(costs.rows(), costs.cols());
+    std::size_t n = std::max(costs.rows(), costs.cols());
+    Matrix<T> square (n, n, T(0));
+    for (std::size_t r=0; r<real_rows; ++r)
+        for (std::size_t c=0; c<n; ++c)
+            square[r][c] = transposed ? costs[c][r] : costs[r][c];
+    MatrixView<T> matrix (square);
+    
+    std::vector<Node> nodes (1);
+    {
+        PathBuffers<P> buf;
+        buf.reset(n, n);
+        for (std::size_t i=1; i<=n; ++i)
+            if (augment_row(matrix, buf, i) < 0)
+                return best; // forbidden cells leave no assignment at all
+        nodes[0].u = buf.u;
+        nodes[0].v = buf.v;
+        nodes[0].p = buf.p;
+        for (std::size_t j=1; j<=n; ++j)
+            if (static_cast<std::size_t>(buf.p[j]) <= real_rows)
+                nodes[0].cost += matrix[buf.p[j]-1][j-1];
+    }
+    
+    using Entry = std::pair<typename accumulator<T>::type, std::size_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    open.emplace(nodes[0].cost, 0);
+    
+    Matrix<char> blocked (n, n, 0);
+    std::vector<int> col_of (n), rank (n), free;
+    std::vector<char> is_forced (n);
+    
+    while (!open.empty() && best.size() < k) {
+        std::size_t id = open.top().second;
+        open.pop();
+        Node node = std::move(nodes[id]);
+        
+        for (std::size_t j=1; j<=n; ++j)
+            col_of[node.p[j]-1] = j-1;
+        
+        Solution<T> solution;
+        solution.cost = node.cost;
+        if (transposed) {
+            solution.assignment.assign(costs.rows(), -1);
+            for (std::size_t r=0; r<real_rows; ++r)
+                solution.assignment[col_of[r]] = r;
+        }
+        else {
+            solution.assignment.assign(col_of.begin(), col_of.begin() + real_rows);
+        }
+        best.push_back(std::move(solution));
+        if (best.size() == k)
+            break;
+        
+        // split what is left of the node over its free real rows
+        std::fill(is_forced.begin(), is_forced.end(), 0);
+        for (int r: node.forced)
+            is_forced[r] = 1;
+        free.clear();
+        std::fill(rank.begin(), rank.end(), -1);
+        for (std::size_t r=0; r<real_rows; ++r)
+            if (!is_forced[r]) {
+                rank[col_of[r]] = free.size();
+                free.push_back(r);
+            }
+        for (std::size_t r=real_rows; r<n; ++r)
+            rank[col_of[r]] = n; // virtual rows are never forced
+        
+        for (auto& pair: node.blocked)
+            blocked[pair.first][pair.second] = 1;
+        
+        std::vector<Node> children (free.size());
+        std::vector<char> feasible (free.size());
+        parallel_for(pool, free.size(), free.size() * n * n, [&](std::size_t b, std::size_t e) {
+            PathBuffers<P> buf;
+            buf.reset(n, n);
+            for (std::size_t t=b; t<e; ++t)
+                feasible[t] = murty_child(matrix, node, free, col_of, rank, blocked, 
+                                          real_rows, t, buf, children[t]);
+        });
+        
+        for (auto& pair: node.blocked)
+            blocked[pair.first][pair.second] = 0;
+        
+        for (std::size_t t=0; t<children.size(); ++t)
+            if (feasible[t]) {
+                open.emplace(children[t].cost, nodes.size());
+                nodes.push_back(std::move(children[t]));
+            }
+    }
+    
+    return best;
+}
+
+template<template <typename, typename...> class Container,
+         typename T,
+         typename... Args>
+typename std::enable_if<std::is_arithmetic<T>::value, std::vector<Solution<T>>>::type
+k_best(const Container<Container<T,Args...>>& costs,
+       std::size_t k,
+       ThreadPool* pool = nullptr)
+{
+    Matrix<T> copy (costs.size(), costs.begin()->size());
+    std::size_t r = 0;
+    for (auto& vec: costs)
+        std::copy(vec.begin(), vec.end(), copy[r++]);
+    return k_best(MatrixView<T>(copy), k, pool);
+}
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, std::vector<Solution<T>>>::type
+k_best(const Matrix<T>& costs,
+       std::size_t k,
+       ThreadPool* pool = nullptr)
+{
+    return k_best(MatrixView<T>(costs), k, pool);
+}
+
+/* Rows of a cost function computed on demand, keeping the capacity most recently used
+ * rows.  It stands in for the matrix of the shortest path engine, which reads whole 
+ * rows, so only capacity x cols costs are ever stored.  The least recently used row 
+ * is found by a scan over the slots, small next to computing a row. */
+template<typename T, typename F>
+class RowCache {
+public:
+    RowCache(std::size_t rows, std::size_t cols, F& cost, std::size_t capacity)
+        : rows_ {rows}, cols_ {cols}, cost_ (cost), 
+          slots_ (std::max<std::size_t>(capacity, 1), cols),
+          slot_of_ (rows, -1), row_in_ (slots_.rows(), -1), used_ (slots_.rows(), 0) {}
+    
+    // row r, valid until capacity other rows have been asked for
+    const T* operator[](std::size_t r)
+    {
+        int slot = slot_of_[r];
+        if (slot != -1) {
+            ++hits_;
+        }
+        else {
+            ++misses_;
+            slot = std::min_element(used_.begin(), used_.end()) - used_.begin();
+            if (row_in_[slot] != -1)
+                slot_of_[row_in_[slot]] = -1;
+            row_in_[slot] = r;
+            slot_of_[r] = slot;
+            
+            T* row = slots_[slot];
+            for (std::size_t c=0; c<cols_; ++c)
+                row[c] = cost_(r, c);
+        }
+        used_[slot] = ++clock_;
+        return slots_[slot];
+    }
+    
+    std::size_t rows() const {return rows_;}
+    std::size_t cols() const {return cols_;}
+    std::size_t hits() const {return hits_;}
+    std::size_t misses() const {return misses_;}
+    
+private:
+    std::size_t rows_;
+    std::size_t cols_;
+    F& cost_;
+    Matrix<T> slots_;
+    std::vector<int> slot_of_; // slot holding each row, -1 if not cached
+    std::vector<int> row_in_;  // row held by each slot
+    std::vector<std::uint64_t> used_;
+    std::uint64_t clock_ = 0;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+};
+
+/* Shortest path solve of the rows x cols problem cost(i, j), rows <= cols */
+template<typename T, typename F>
+void solve_rows(std::size_t rows,
+                std::size_t cols, 
+                F& cost, 
+                std::size_t cache_rows,
+                std::vector<int>& StarInRow,
+                std::vector<int>& StarInCol)
+{
+    RowCache<T, F> cache (rows, cols, cost, cache_rows);
+    PathBuffers<typename potential<T>::type> buf;
+    buf.reset(rows, cols);
+    StarInRow.assign(rows, -1);
+    StarInCol.assign(cols, -1);
+    shortest_augmenting_path(cache, buf, StarInRow, StarInCol);
+}
+
+/* Solve a problem given as a function, cost(i, j) being the cost of row i and col j,
+ * for problems whose matrix does not fit in memory.  Costs are computed a row at a 
+ * time and the cache_rows most recently used rows are kept, so memory is 
+ * O(cache_rows*cols + rows + cols).  Uses the shortest path engine. */
+template<typename F,
+         typename T = typename std::decay<decltype(std::declval<F&>()(std::size_t(), std::size_t()))>::type>
+typename std::enable_if<std::is_arithmetic<T>::value, Solution<T>>::type
+hungarian(std::size_t rows,
+          std::size_t cols,
+          F cost,
+          std::size_t cache_rows = 64)
+{
+    Solution<T> solution;
+    std::vector<int> StarInRow;
+    std::vector<int> StarInCol;
+    
+    if (rows <= cols) {
+        solve_rows<T>(rows, cols, cost, cache_rows, StarInRow, StarInCol);
+        solution.assignment = std::move(StarInRow);
+    }
+    else {
+        auto flipped = [&cost](std::size_t i, std::size_t j) {return cost(j, i);};
+        solve_rows<T>(cols, rows, flipped, cache_rows, StarInRow, StarInCol);
+        solution.assignment = std::move(StarInCol);
+    }
+    
+    for (std::size_t r=0; r<rows; ++r)
+        if (solution.assignment[r] != -1)
+            solution.cost += cost(r, solution.assignment[r]);
+    
+    return solution;
+}
+
+/* Print the cost matrix and the assignment as a 0/1 mask */
+template<typename Costs, typename T>
+void print_solution(std::ostream& os,
+                    const Costs& original,
+                    const Solution<T>& solution)
+{
+    std::size_t cols = original.begin()->size();
+    
+    os << "Cost Matrix: \n" << original << "\n" 
+       << "Optimal assignment: \n";
+    print_assignment(os, solution.assignment, cols);
+}
+
+/* Cost type of a batch problem: nested containers, a Matrix or a MatrixView */
+template<typename Problem, typename = void>
+struct problem_value {};
+
+template<typename Problem>
+struct problem_value<Problem, typename std::conditional<true, void, 
+                                  typename Problem::value_type::value_type>::type> {
+    using type = typename Problem::value_type::value_type;
+};
+
+template<typename T>
+struct problem_value<Matrix<T>, void> {
+    using type = T;
+};
+
+template<typename T>
+struct problem_value<MatrixView<T>, void> {
+    using type = T;
+};
+
+/* Solve count independent problems, each one a Container<Container<T>> like the input
+ * of hungarian(), a Matrix or a MatrixView (read in place), and return their solutions 
+ * in input order.  Nothing is printed.
+ * With a thread pool every thread takes the next unsolved problem until none is 
+ * left, reusing one workspace per thread; the problems themselves are solved serially.
+ * The first exception thrown by any problem is rethrown once the batch is done. */
+template<typename Problem,
+         typename T = typename problem_value<Problem>::type>
+typename std::enable_if<std::is_arithmetic<T>::value, std::vector<Solution<T>>>::type
+solve_batch(const Problem* problems,
+            std::size_t count,
+            bool allow_negatives = true,
+            Algorithm algorithm = Algorithm::Munkres,
+            ThreadPool* pool = nullptr)
+{
+    std::vector<Solution<T>> solutions (count);
+    
+    std::size_t workers = (pool != nullptr && count > 1) ? pool->size() : 1;
+    std::vector<Workspace<T>> spaces (workers);
+    std::atomic<std::size_t> next {0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    
+    // [b, e) are workspace indices, one per thread
+    auto work = [&](std::size_t b, std::size_t e) {
+        for (std::size_t w = b; w < e; ++w) {
+            Workspace<T>& ws = spaces[w];
+            
+            for (std::size_t i = next++; i < count; i = next++) {
+                try {
+                    load_problem(ws, problems[i], allow_negatives);
+                    solve_workspace(ws, algorithm, nullptr);
+                    solutions[i].cost = output_solution(ws);
+                    solutions[i].assignment = ws.StarInRow;
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock (error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        }
+    };
+    
+    if (workers > 1)
+        pool->run(workers, work);
+    else
+        work(0, 1);
+    
+    if (error)
+        std::rethrow_exception(error);
+    
+    return solutions;
+}
+
+template<typename Problem,
+         typename T = typename problem_value<Problem>::type>
+typename std::enable_if<std::is_arithmetic<T>::value, std::vector<Solution<T>>>::type
+solve_batch(const std::vector<Problem>& problems,
+            bool allow_negatives = true,
+            Algorithm algorithm = Algorithm::Munkres,
+            ThreadPool* pool = nullptr)
+{
+    return solve_batch(problems.data(), problems.size(), allow_negatives, algorithm, pool);
+}
+
+/* count problems of the same rows x cols shape stored back to back in one row-major
+ * buffer, as a pipeline producing a frame of problems hands them over.  Each one is
+ * solved in place through a view, so the costs are never copied. */
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, std::vector<Solution<T>>>::type
+solve_batch(const T* data,
+            std::size_t count,
+            std::size_t rows,
+            std::size_t cols,
+            bool allow_negatives = true,
+            Algorithm algorithm = Algorithm::Munkres,
+            ThreadPool* pool = nullptr)
+{
+    std::vector<MatrixView<T>> views;
+    views.reserve(count);
+    for (std::size_t b=0; b<count; ++b)
+        views.emplace_back(data + b * rows * cols, rows, cols);
+    
+    return solve_batch(views.data(), count, allow_negatives, algorithm, pool);
+}
+
+
+/* What SolveService::submit() hands back.  result is the future of the solution, or of
+ * the exception the solve threw, and stays empty when a callback takes the result 
+ * instead.  cancel() makes the solve throw SolveCancelled at its next poll, or before
+ * it starts if it is still queued. */
+template<typename T>
+struct SolveTicket {
+    std::future<Solution<T>> result;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+    
+    void cancel() {cancelled->store(true, std::memory_order_relaxed);}
+};
+
+/* Solves problems submitted from any thread on a fixed set of worker threads, each one
+ * reusing its own workspace, so that request threads never run a solve themselves.
+ * Submitting is lock-free: a problem goes to one of two MpmcQueue lanes by size, those
+ * of at least large_cells cells to the large lane.  Workers take small problems first
+ * and, when there is more than one, the first worker never takes a large one, so a 
+ * burst of big matrices cannot hold a small one up behind them.  Idle workers sleep on
+ * a condition variable, which submit() only touches while one of them is asleep.
+ * 
+ * The costs are copied, or moved from a Matrix rvalue, into the request, so the 
+ * caller's data may go away once submit() returns.  Each request has its own engine,
+ * objective and deadline, see StopCondition.  A full lane makes submit() throw 
+ * std::runtime_error.  A callback given to submit() runs on the worker thread and 
+ * must not throw.  Destroying the service lets the running solves finish and fails the
+ * queued ones with SolveCancelled. */
+template<typename T>
+class SolveService {
+public:
+    using Clock = StopCondition::Clock;
+    using Callback = std::function<void(const Solution<T>&, std::exception_ptr)>;
+    
+    explicit SolveService(std::size_t threads = std::thread::hardware_concurrency(),
+                          std::size_t large_cells = 1 << 16,
+                          std::size_t capacity = 1024,
+                          bool allow_negatives = true)
+        : small_ (capacity), large_ (capacity),
+          large_cells_ {large_cells}, allow_negatives_ {allow_negatives}
+    {
+        threads = std::max<std::size_t>(threads, 1);
+        for (std::size_t i=0; i<threads; ++i)
+            workers_.emplace_back([this, i, threads]{work(i > 0 || threads == 1);});
+    }
+    
+    SolveService(const SolveService&) = delete;
+    SolveService& operator=(const SolveService&) = delete;
+    
+    ~SolveService()
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t: workers_)
+            t.join();
+        
+        Job* job;
+        for (Lane* lane: {&small_, &large_})
+            while (lane->queue.pop(job)) {
+                std::unique_ptr<Job> owned (job);
+                finish(*owned, Solution<T>(), std::make_exception_ptr(SolveCancelled("Solve service stopped")));
+            }
+    }
+    
+    std::size_t size() const {return workers_.size();}
+    
+    /* Queue a problem given as nested containers, a Matrix or a MatrixView, and get
+     * its solution through the future of the ticket */
+    template<typename Problem>
+    SolveTicket<T> submit(Problem&& costs,
+                          Clock::time_point deadline = Clock::time_point::max(),
+                          Algorithm algorithm = Algorithm::Munkres,
+                          Objective objective = Objective::Minimize)
+    {
+        std::unique_ptr<Job> job (new Job(to_matrix(std::forward<Problem>(costs)), algorithm, objective, deadline));
+        SolveTicket<T> ticket;
+        ticket.result = job->promise.get_future();
+        ticket.cancelled = job->cancelled;
+        enqueue(std::move(job));
+        return ticket;
+    }
+    
+    // or have done called with the solution, or the exception, once it is solved
+    template<typename Problem>
+    SolveTicket<T> submit(Problem&& costs,
+                          Callback done,
+                          Clock::time_point deadline = Clock::time_point::max(),
+                          Algorithm algorithm = Algorithm::Munkres,
+                          Objective objective = Objective::Minimize)
+    {
+        std::unique_ptr<Job> job (new Job(to_matrix(std::forward<Problem>(costs)), algorithm, objective, deadline));
+        job->done = std::move(done);
+        SolveTicket<T> ticket;
+        ticket.cancelled = job->cancelled;
+        enqueue(std::move(job));
+        return ticket;
+    }
+    
+private:
+    struct Job {
+        Job(Matrix<T>&& matrix, Algorithm algo, Objective obj, Clock::time_point deadline)
+            : costs (std::move(matrix)), algorithm {algo}, objective {obj},
+              cancelled {std::make_shared<std::atomic<bool>>(false)},
+              stop (deadline, cancelled.get()) {}
+        
+        Matrix<T> costs;
+        Algorithm algorithm;
+        Objective objective;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        StopCondition stop;
+        std::promise<Solution<T>> promise;
+        Callback done;
+    };
+    
+    // queued counts the jobs pushed and not yet taken, it only tells sleepers to wake
+    struct Lane {
+        explicit Lane(std::size_t capacity) : queue (capacity) {}
+        
+        MpmcQueue<Job*> queue;
+        std::atomic<long> queued {0};
+    };
+    
+    static Matrix<T> to_matrix(Matrix<T>&& costs) {return std::move(costs);}
+    
+    static Matrix<T> to_matrix(const MatrixView<T>& costs)
+    {
+        Matrix<T> res (costs.rows(), costs.cols());
+        for (std::size_t r=0; r<costs.rows(); ++r)
+            std::copy(costs[r], costs[r] + costs.cols(), res[r]);
+        return res;
+    }
+    
+    static Matrix<T> to_matrix(const Matrix<T>& costs) {return to_matrix(MatrixView<T>(costs));}
+    
+    template<template <typename, typename...> class Container,
+             typename... Args>
+    static Matrix<T> to_matrix(const Container<Container<T,Args...>>& costs)
+    {
+        Matrix<T> res (costs.size(), costs.size() ? costs.begin()->size() : 0);
+        std::size_t r = 0;
+        for (auto& vec: costs)
+            std::copy(vec.begin(), vec.end(), res[r++]);
+        return res;
+    }
+    
+    void enqueue(std::unique_ptr<Job> job)
+    {
+        Lane& lane = job->costs.rows() * job->costs.cols() >= large_cells_ ? large_ : small_;
+        if (!lane.queue.push(job.get()))
+            throw std::runtime_error("Solve queue is full");
+        job.release();
+        lane.queued++;
+        
+        // a worker about to sleep either sees queued or is woken here
+        if (sleepers_ > 0) {
+            std::lock_guard<std::mutex> lock (mutex_);
+            wake_.notify_all();
+        }
+    }
+    
+    static bool take(Lane& lane, Job*& job)
+    {
+        if (!lane.queue.pop(job))
+            return false;
+        lane.queued--;
+        return true;
+    }
+    
+    void work(bool takes_large)
+    {
+        Workspace<T> ws;
+        while (!stop_) {
+            Job* job = nullptr;
+            if (take(small_, job) || (takes_large && take(large_, job))) {
+                std::unique_ptr<Job> owned (job);
+                run(ws, *owned);
+                continue;
+            }
+            
+            std::unique_lock<std::mutex> lock (mutex_);
+            ++sleepers_;
+            wake_.wait(lock, [&]{return stop_ || small_.queued > 0 || (takes_large && large_.queued > 0);});
+            --sleepers_;
+        }
+    }
+    
+    void run(Workspace<T>& ws, Job& job)
+    {
+        Solution<T> solution;
+        std::exception_ptr error;
+        try {
+            job.stop.check(); // expired or cancelled while queued
+            load_problem(ws, MatrixView<T>(job.costs), allow_negatives_, T(-1), job.objective);
+            solve_workspace(ws, job.algorithm, nullptr, job.stop);
+            solution.cost = output_solution(ws);
+            solution.assignment = ws.StarInRow;
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        finish(job, solution, error);
+    }
+    
+    static void finish(Job& job, const Solution<T>& solution, std::exception_ptr error)
+    {
+        if (job.done)
+            job.done(solution, error);
+        else if (error)
+            job.promise.set_exception(error);
+        else
+            job.promise.set_value(solution);
+    }
+    
+    Lane small_;
+    Lane large_;
+    std::size_t large_cells_;
+    bool allow_negatives_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<int> sleepers_ {0};
+    std::atomic<bool> stop_ {false};
+    std::vector<std::thread> workers_;
+};
+
+/* Sparse cost matrix in compressed sparse row form, for problems where most pairs are 
+ * forbidden.  Only allowed (row, col) pairs are stored: the edges of row r are the 
+ * entries start[r] .. start[r+1]-1 of col and cost.  Build it row by row with add() 
+ * and end_row(). */
+template<typename T>
+struct SparseMatrix {
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    std::vector<std::size_t> start {0};
+    std::vector<int> col;
+    std::vector<T> cost;
+    
+    SparseMatrix() = default;
+    explicit SparseMatrix(std::size_t columns) : cols {columns} {}
+    
+    // allow col c for the row being built
+    void add(int c, T value)
+    {
+        if (c < 0 || c >= static_cast<int>(cols))
+            throw std::out_of_range("Sparse column index out of range");
+        col.push_back(c);
+        cost.push_back(value);
+    }
+    
+    void end_row()
+    {
+        start.push_back(col.size());
+        ++rows;
+    }
+    
+    std::size_t edges() const {return col.size();}
+};
+
+/* Counting sort of the edges by column, O(edges) */
+template<typename T>
+void transpose(const SparseMatrix<T>& in, SparseMatrix<T>& out)
+{
+    out.rows = in.cols;
+    out.cols = in.rows;
+    out.start.assign(in.cols + 1, 0);
+    out.col.resize(in.edges());
+    out.cost.resize(in.edges());
+    
+    for (auto c: in.col)
+        out.start[c + 1]++;
+    for (std::size_t c=0; c<in.cols; ++c)
+        out.start[c + 1] += out.start[c];
+    
+    std::vector<std::size_t> next (out.start.begin(), out.start.end() - 1);
+    for (std::size_t r=0; r<in.rows; ++r)
+        for (std::size_t e=in.start[r]; e<in.start[r+1]; ++e) {
+            std::size_t pos = next[in.col[e]]++;
+            out.col[pos] = r;
+            out.cost[pos] = in.cost[e];
+        }
+}
+
+/* Buffers of the sparse engine, all O(rows + cols + edges).  dist, pred_row, pred_edge
+ * and done are per column; touched lists the columns a search reached so that only 
+ * those are reset.  RowEdge(i) is the edge behind the star of row i. */
+template<typename P>
+struct SparseBuffers {
+    std::vector<P> u;
+    std::vector<P> v;
+    std::vector<P> dist;
+    std::vector<int> pred_row;
+    std::vector<std::size_t> pred_edge;
+    std::vector<char> done;
+    std::vector<int> touched;
+    std::vector<std::pair<P, int>> heap;
+    std::vector<int> StarInRow;
+    std::vector<int> StarInCol;
+    std::vector<std::size_t> RowEdge;
+    
+    void reset(std::size_t rows, std::size_t cols, std::size_t edges)
+    {
+        u.assign(rows, 0);
+        v.assign(cols, 0);
+        dist.assign(cols, std::numeric_limits<P>::max());
+        pred_row.assign(cols, -1);
+        pred_edge.assign(cols, 0);
+        done.assign(cols, 0);
+        touched.clear();
+        touched.reserve(cols);
+        heap.clear();
+        heap.reserve(edges);
+        StarInRow.assign(rows, -1);
+        StarInCol.assign(cols, -1);
+        RowEdge.assign(rows, 0);
+    }
+};
+
+/* Shortest augmenting path engine over the allowed edges only.  It keeps the same dual
+ * potentials as the dense engine, C(i,j) - u(i) - v(j) >= 0 on every edge, but grows 
+ * each tree with Dijkstra on a binary heap, so a row costs O(E log E) in the edges it 
+ * reaches instead of O(n^2).  Needs rows <= cols; throws if some row cannot be matched,
+ * i.e. the allowed pairs hold no complete assignment. */
+template<typename T, typename P>
+void sparse_augmenting_path(const SparseMatrix<T>& matrix, SparseBuffers<P>& buf)
+{
+    const P INF = std::numeric_limits<P>::max();
+    
+    int rows = matrix.rows;
+    buf.reset(matrix.rows, matrix.cols, matrix.edges());
+    
+    auto& u = buf.u;
+    auto& v = buf.v;
+    auto& dist = buf.dist;
+    auto& done = buf.done;
+    auto& heap = buf.heap;
+    auto later = [](const std::pair<P, int>& a, const std::pair<P, int>& b) {return a.first > b.first;};
+    
+    // start from the row minima so that every reduced cost is non-negative
+    for (int r=0; r<rows; ++r) {
+        if (matrix.start[r] == matrix.start[r+1])
+            throw std::runtime_error("No feasible assignment: a row has no allowed column");
+        u[r] = *std::min_element(matrix.cost.begin() + matrix.start[r], 
+                                 matrix.cost.begin() + matrix.start[r+1]);
+    }
+    
+    auto relax = [&](int i, P base) {
+        for (std::size_t e=matrix.start[i]; e<matrix.start[i+1]; ++e) {
+            int j = matrix.col[e];
+            if (done[j])
+                continue;
+            P d = base + static_cast<P>(matrix.cost[e]) - u[i] - v[j];
+            if (d < dist[j]) {
+                if (dist[j] == INF)
+                    buf.touched.push_back(j);
+                dist[j] = d;
+                buf.pred_row[j] = i;
+                buf.pred_edge[j] = e;
+                heap.emplace_back(d, j);
+                std::push_heap(heap.begin(), heap.end(), later);
+            }
+        }
+    };
+    
+    for (int s=0; s<rows; ++s) {
+        buf.touched.clear();
+        heap.clear();
+        int sink = -1;
+        
+        relax(s, 0);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            auto top = heap.back();
+            heap.pop_back();
+            
+            int j = top.second;
+            if (done[j] || top.first > dist[j])
+                continue; // stale entry
+            done[j] = 1;
+            
+            if (buf.StarInCol[j] == -1) {
+                sink = j;
+                break;
+            }
+            relax(buf.StarInCol[j], dist[j]);
+        }
+        
+        if (sink == -1)
+            throw std::runtime_error("No feasible assignment: the allowed pairs cannot match every row");
+        
+        // shift the potentials of the tree so its edges stay non-negative
+        P total = dist[sink];
+        u[s] += total;
+        for (int j: buf.touched) {
+            if (done[j] && j != sink) {
+                u[buf.StarInCol[j]] += total - dist[j];
+                v[j] -= total - dist[j];
+            }
+            dist[j] = INF;
+            done[j] = 0;
+        }
+        
+        // flip the path back to s
+        for (int j = sink; ; ) {
+            int i = buf.pred_row[j];
+            int next = buf.StarInRow[i];
+            buf.StarInRow[i] = j;
+            buf.StarInCol[j] = i;
+            buf.RowEdge[i] = buf.pred_edge[j];
+            if (i == s)
+                break;
+            j = next;
+        }
+    }
+}
+
+/* Solve a sparse problem.  Cost and memory scale with the number of allowed pairs.
+ * Every row gets a column when rows <= cols, every column a row otherwise; if the 
+ * allowed pairs admit no such assignment a std::runtime_error is thrown. */
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, Solution<T>>::type
+hungarian(const SparseMatrix<T>& costs,
+          bool allow_negatives = true)
+{
+    if (!allow_negatives)
+        for (auto n: costs.cost)
+            if (n < 0)
+                throw std::runtime_error("Only non-negative values allowed");
+    
+    SparseBuffers<typename potential<T>::type> buf;
+    SparseMatrix<T> flipped;
+    bool transposed = costs.rows > costs.cols;
+    if (transposed)
+        transpose(costs, flipped);
+    const SparseMatrix<T>& matrix = transposed ? flipped : costs;
+    
+    sparse_augmenting_path(matrix, buf);
+    
+    Solution<T> solution;
+    for (std::size_t r=0; r<matrix.rows; ++r)
+        solution.cost += matrix.cost[buf.RowEdge[r]];
+    solution.assignment = transposed ? std::move(buf.StarInCol) : std::move(buf.StarInRow);
+    return solution;
+}
+
+/* Binary matrix files: a 32 byte header followed by the rows*cols costs in row-major 
+ * order, native byte order, with no padding between rows.
+ *     char magic[4] = "MUNK", uint32 version = 1, uint32 type, uint32 reserved = 0,
+ *     uint64 rows, uint64 cols
+ * The data starts 32 bytes in, so a mapped file can be read in place as a MatrixView. */
+struct MatrixFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t type;
+    std::uint32_t reserved;
+    std::uint64_t rows;
+    std::uint64_t cols;
+};
+
+static_assert(sizeof(MatrixFileHeader) == 32, "matrix file header must be 32 bytes");
+
+enum class MatrixFileType : std::uint32_t {
+    Int32 = 1,
+    Int64 = 2,
+    Float = 3,
+    Double = 4
+};
+
+template<typename T> struct matrix_file_type;
+template<> struct matrix_file_type<std::int32_t> {static constexpr MatrixFileType value = MatrixFileType::Int32;};
+template<> struct matrix_file_type<std::int64_t> {static constexpr MatrixFileType value = MatrixFileType::Int64;};
+template<> struct matrix_file_type<float>        {static constexpr MatrixFileType value = MatrixFileType::Float;};
+template<> struct matrix_file_type<double>       {static constexpr MatrixFileType value = MatrixFileType::Double;};
+
+/* Check the header at the start of size bytes of file data, throw if it is not a
+ * complete matrix file */
+inline MatrixFileHeader read_matrix_header(const char* data, std::size_t size)
+{
+    MatrixFileHeader header;
+    if (size < sizeof(header))
+        throw std::runtime_error("Matrix file too short for its header");
+    std::memcpy(&header, data, sizeof(header));
+    
+    if (std::memcmp(header.magic, "MUNK", 4) != 0 || header.version != 1)
+        throw std::runtime_error("Not a version 1 matrix file");
+    
+    std::size_t element;
+    switch (static_cast<MatrixFileType>(header.type)) {
+        case MatrixFileType::Int32:  element = 4; break;
+        case MatrixFileType::Int64:  element = 8; break;
+        case MatrixFileType::Float:  element = 4; break;
+        case MatrixFileType::Double: element = 8; break;
+        default: throw std::runtime_error("Unknown matrix file element type");
+    }
+    if (header.rows == 0 || header.cols == 0 || 
+        (size - sizeof(header)) / element / header.cols < header.rows)
+        throw std::runtime_error("Matrix file truncated or empty");
+    
+    return header;
+}
+
+/* View of the costs of matrix file data, which must hold T elements */
+template<typename T>
+MatrixView<T> matrix_file_view(const char* data, std::size_t size)
+{
+    MatrixFileHeader header = read_matrix_header(data, size);
+    if (header.type != static_cast<std::uint32_t>(matrix_file_type<T>::value))
+        throw std::runtime_error("Matrix file holds another element type");
+    
+    return MatrixView<T>(reinterpret_cast<const T*>(data + sizeof(header)), header.rows, header.cols);
+}
+
+template<typename T>
+void write_matrix_file(std::ostream& os, const MatrixView<T>& matrix)
+{
+    MatrixFileHeader header {{'M', 'U', 'N', 'K'}, 1, 
+                             static_cast<std::uint32_t>(matrix_file_type<T>::value), 0,
+                             matrix.rows(), matrix.cols()};
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (std::size_t r=0; r<matrix.rows(); ++r)
+        os.write(reinterpret_cast<const char*>(matrix[r]), matrix.cols() * sizeof(T));
+    
+    if (!os)
+        throw std::runtime_error("Failed writing the matrix file");
+}
+
+#ifdef MUNKRES_HAS_MMAP
+/* Read-only memory map of a whole file.  Pages are read on first touch, so opening a
+ * huge matrix costs nothing until the solver walks it. */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::runtime_error("Cannot open " + path);
+        
+        struct stat st;
+        if (::fstat(fd, &st) == -1 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        size_ = st.st_size;
+        
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps the file alive
+        if (addr == MAP_FAILED)
+            throw std::runtime_error("Cannot map " + path);
+        data_ = static_cast<const char*>(addr);
+    }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    ~MappedFile()
+    {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    
+    const char* data() const {return data_;}
+    std::size_t size() const {return size_;}
+    
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+#endif // MUNKRES_HAS_MMAP
+
+} // end of namespace munkres
+
+#endif // MUNKRES_HUNGARIAN_HPP
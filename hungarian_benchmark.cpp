@@ -0,0 +1,172 @@
+/* Benchmarks of the solver, built on Google Benchmark:
+ *
+ *     g++ -O2 -std=c++11 -pthread -o hungarian_benchmark hungarian_benchmark.cpp -lbenchmark
+ *     ./hungarian_benchmark --benchmark_filter='BM_Solve<int, VectorInput>/rows:512/'
+ *
+ * Every case solves one generated problem per iteration and reports the time per solve,
+ * the heap allocations and allocated bytes per solve, and bytes_per_second over the
+ * cost matrix, i.e. one pass over the costs it touches.  Arguments are rows, cols, the
+ * cost distribution and the engine (0 Munkres, 1 Jonker-Volgenant, 2 auction).  Sizes go up to
+ * 8192, where a single Munkres solve takes minutes: filter for what you compare. */
+
+#include "hungarian.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Count every heap allocation of the process, the solver allocates through operator new
+static std::atomic<std::size_t> allocations {0};
+static std::atomic<std::size_t> allocated_bytes {0};
+
+void* operator new(std::size_t size)
+{
+    allocations++;
+    allocated_bytes += size;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+// kept out of line, inlined into callers gcc pairs the free with the new and warns
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, std::size_t) noexcept {::operator delete(p);}
+
+enum Distribution {
+    Uniform,   // independent costs over a wide range
+    Clustered, // rows and cols drawn around a few centers, cost is their distance
+    LowRank,   // rank 2 products, many near-equivalent assignments
+    ManyTies   // costs in 0..3, lots of zeros after the reductions
+};
+
+template<typename T>
+Munkres::Matrix<T> make_costs(std::size_t rows, std::size_t cols, Distribution dist)
+{
+    std::mt19937 gen (rows * 7919 + cols);
+    std::uniform_real_distribution<double> unit (0.0, 1.0);
+    Munkres::Matrix<T> costs (rows, cols);
+
+    std::vector<double> a (rows), b (cols), a2 (rows), b2 (cols);
+    for (auto& x: a) x = unit(gen);
+    for (auto& x: b) x = unit(gen);
+    for (auto& x: a2) x = unit(gen);
+    for (auto& x: b2) x = unit(gen);
+
+    for (std::size_t r=0; r<rows; ++r)
+        for (std::size_t c=0; c<cols; ++c) {
+            double val = 0;
+            switch (dist) {
+                case Uniform:
+                    val = unit(gen) * 1e6;
+                    break;
+                case Clustered:
+                    val = std::abs(std::floor(a[r] * 8) - std::floor(b[c] * 8)) * 1e5 + unit(gen) * 1e3;
+                    break;
+                case LowRank:
+                    val = (a[r] * b[c] + a2[r] * b2[c]) * 1e6;
+                    break;
+                case ManyTies:
+                    val = std::floor(unit(gen) * 4);
+                    break;
+            }
+            costs[r][c] = static_cast<T>(val);
+        }
+
+    return costs;
+}
+
+// How the problem is handed to the solver
+struct MatrixInput {};
+struct VectorInput {};
+struct ListInput {};
+
+template<typename T>
+const Munkres::Matrix<T>& convert(const Munkres::Matrix<T>& costs, MatrixInput)
+{
+    return costs;
+}
+
+template<typename T>
+std::vector<std::vector<T>> convert(const Munkres::Matrix<T>& costs, VectorInput)
+{
+    std::vector<std::vector<T>> res (costs.rows());
+    for (std::size_t r=0; r<costs.rows(); ++r)
+        res[r].assign(costs[r], costs[r] + costs.cols());
+    return res;
+}
+
+template<typename T>
+std::list<std::list<T>> convert(const Munkres::Matrix<T>& costs, ListInput)
+{
+    std::list<std::list<T>> res;
+    for (std::size_t r=0; r<costs.rows(); ++r)
+        res.emplace_back(costs[r], costs[r] + costs.cols());
+    return res;
+}
+
+template<typename T, typename Input>
+void BM_Solve(benchmark::State& state)
+{
+    std::size_t rows = state.range(0);
+    std::size_t cols = state.range(1);
+    auto dist = static_cast<Distribution>(state.range(2));
+    auto algorithm = static_cast<Munkres::Algorithm>(state.range(3));
+
+    auto costs = make_costs<T>(rows, cols, dist);
+    const auto& input = convert(costs, Input());
+
+    std::size_t allocs = allocations;
+    std::size_t bytes = allocated_bytes;
+
+    for (auto _: state) {
+        auto solution = Munkres::hungarian(input, true, algorithm);
+        benchmark::DoNotOptimize(solution.cost);
+    }
+
+    state.counters["allocs"] = benchmark::Counter(allocations - allocs, benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes"] = benchmark::Counter(allocated_bytes - bytes, benchmark::Counter::kAvgIterations);
+    state.SetBytesProcessed(state.iterations() * rows * cols * sizeof(T));
+}
+
+// small to huge, square and rectangular both ways, every distribution and engine
+void sizes(benchmark::internal::Benchmark* b, std::size_t largest)
+{
+    const std::vector<std::pair<int, int>> shapes {
+        {8, 8}, {32, 32}, {128, 128}, {512, 512}, {2048, 2048}, {8192, 8192},
+        {8, 64}, {64, 512}, {512, 4096}, {1024, 8192}, {4096, 512}
+    };
+
+    for (auto& shape: shapes)
+        if (static_cast<std::size_t>(std::max(shape.first, shape.second)) <= largest)
+            for (int dist = Uniform; dist <= ManyTies; ++dist)
+                for (int engine = 0; engine < 3; ++engine)
+                    b->Args({shape.first, shape.second, dist, engine});
+
+    b->ArgNames({"rows", "cols", "dist", "engine"});
+}
+
+void all_sizes(benchmark::internal::Benchmark* b) {sizes(b, 8192);}
+void list_sizes(benchmark::internal::Benchmark* b) {sizes(b, 512);} // no point timing huge lists
+
+BENCHMARK_TEMPLATE(BM_Solve, std::int32_t, MatrixInput)->Apply(all_sizes);
+BENCHMARK_TEMPLATE(BM_Solve, std::int64_t, MatrixInput)->Apply(all_sizes);
+BENCHMARK_TEMPLATE(BM_Solve, double, MatrixInput)->Apply(all_sizes);
+BENCHMARK_TEMPLATE(BM_Solve, std::int32_t, VectorInput)->Apply(all_sizes);
+BENCHMARK_TEMPLATE(BM_Solve, std::int64_t, VectorInput)->Apply(all_sizes);
+BENCHMARK_TEMPLATE(BM_Solve, double, VectorInput)->Apply(all_sizes);
+BENCHMARK_TEMPLATE(BM_Solve, std::int32_t, ListInput)->Apply(list_sizes);
+BENCHMARK_TEMPLATE(BM_Solve, std::int64_t, ListInput)->Apply(list_sizes);
+BENCHMARK_TEMPLATE(BM_Solve, double, ListInput)->Apply(list_sizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,137 @@
+/* Command line solver for matrix files (see MatrixFileHeader in hungarian.hpp).
+ * The file is memory mapped and solved in place through a MatrixView, so a huge 
+ * instance is never parsed or copied before the solve.
+ *
+ *     hungarian_cli costs.bin [-a munkres|jv|auction] [-t threads] [-o out] [-f csv|bin]
+ *
+ * The optimal cost goes to stdout.  With -o the assignment is also written, either 
+ * as CSV "row,col" lines (default) or as a rows x 1 int32 matrix file holding the 
+ * col of each row, -1 for none. */
+
+#include "hungarian.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct Options {
+    std::string input;
+    std::string output;
+    bool csv = true;
+    Munkres::Algorithm algorithm = Munkres::Algorithm::Munkres;
+    std::size_t threads = 1;
+};
+
+void usage()
+{
+    std::cerr << "usage: hungarian_cli costs.bin [-a munkres|jv|auction] [-t threads] "
+              << "[-o out] [-f csv|bin]\n";
+    std::exit(2);
+}
+
+Options parse(int argc, char* argv[])
+{
+    Options opt;
+    
+    for (int i=1; i<argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (arg == "-a" && has_value) {
+            std::string name = argv[++i];
+            if (name == "munkres")
+                opt.algorithm = Munkres::Algorithm::Munkres;
+            else if (name == "jv")
+                opt.algorithm = Munkres::Algorithm::JonkerVolgenant;
+            else if (name == "auction")
+                opt.algorithm = Munkres::Algorithm::Auction;
+            else
+                usage();
+        }
+        else if (arg == "-t" && has_value) {
+            opt.threads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "-o" && has_value) {
+            opt.output = argv[++i];
+        }
+        else if (arg == "-f" && has_value) {
+            std::string format = argv[++i];
+            if (format != "csv" && format != "bin")
+                usage();
+            opt.csv = format == "csv";
+        }
+        else if (!arg.empty() && arg[0] != '-' && opt.input.empty()) {
+            opt.input = arg;
+        }
+        else {
+            usage();
+        }
+    }
+    
+    if (opt.input.empty())
+        usage();
+    return opt;
+}
+
+void write_assignment(const Options& opt, const std::vector<int>& assignment)
+{
+    std::ofstream out (opt.output, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Cannot create " + opt.output);
+    
+    if (opt.csv) {
+        for (std::size_t r=0; r<assignment.size(); ++r)
+            if (assignment[r] != -1)
+                out << r << "," << assignment[r] << "\n";
+    }
+    else {
+        Munkres::MatrixView<int> col (assignment.data(), assignment.size(), 1);
+        Munkres::write_matrix_file(out, col);
+    }
+    
+    if (!out)
+        throw std::runtime_error("Failed writing " + opt.output);
+}
+
+template<typename T>
+void solve(const Munkres::MappedFile& file, const Options& opt)
+{
+    std::unique_ptr<Munkres::ThreadPool> pool;
+    if (opt.threads > 1)
+        pool.reset(new Munkres::ThreadPool(opt.threads));
+    
+    auto costs = Munkres::matrix_file_view<T>(file.data(), file.size());
+    auto solution = Munkres::hungarian(costs, true, opt.algorithm, pool.get());
+    
+    std::cout << solution.cost << std::endl;
+    if (!opt.output.empty())
+        write_assignment(opt, solution.assignment);
+}
+
+int main(int argc, char* argv[])
+{
+    using Munkres::MatrixFileType;
+    
+    Options opt = parse(argc, argv);
+    
+    try {
+        Munkres::MappedFile file (opt.input);
+        auto header = Munkres::read_matrix_header(file.data(), file.size());
+        
+        switch (static_cast<MatrixFileType>(header.type)) {
+            case MatrixFileType::Int32:  solve<std::int32_t>(file, opt); break;
+            case MatrixFileType::Int64:  solve<std::int64_t>(file, opt); break;
+            case MatrixFileType::Float:  solve<float>(file, opt); break;
+            case MatrixFileType::Double: solve<double>(file, opt); break;
+        }
+    }
+    catch (std::exception& e) {
+        std::cerr << argv[0] << ": " << e.what() << "\n";
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,733 @@
+/* Randomized differential testing and throughput tracking of the engines.
+ *
+ *     g++ -O2 -std=c++11 -pthread -o hungarian_stress hungarian_stress.cpp
+ *     ./hungarian_stress [-r rounds] [-s seed] [-n max_size] [-z 8,64,256] [-t seconds]
+ *                        [-o results.csv] [-l label]
+ *
+ * Every round draws one problem of random shape, up to max_size a side, from each
+ * generator and solves it, as int8, int16, int, uint32 and double, with Munkres, 
+ * Jonker-Volgenant, the auction, the sparse engine, when it is square up to 16x16 the
+ * fixed size solver, the first three again with a ThreadPool splitting even small 
+ * loops, and Munkres on a SolveService worker.  Up to 12 rows and cols an exhaustive 
+ * search over col subsets gives the reference cost, else the auction does for 
+ * integers, which it solves exactly, and the shortest path engine for doubles.  Every
+ * engine must agree on the cost, or on the problem being infeasible, and return a 
+ * valid assignment of that cost.
+ *
+ * An IncrementalSolver then takes a few random set_row(), set_col() and set_cost() 
+ * edits of the problem, each costs drawn from its generator, and must follow the 
+ * reference of the edited costs.  k_best() ranks the assignments of a corner of at most
+ * 6x7 of the problem, which must match all of them enumerated and sorted by cost.
+ * Munkres and Jonker-Volgenant also solve it under a Budget of a few steps, 
+ * and their BoundedSolution must keep bound <= optimum <= cost, the cost being that of
+ * a valid assignment unless it is incomplete.  With no steps at all both finish from
+ * the same initial assignment, and a square problem must get the same bound from 
+ * either.  A mismatch prints the seed, round and problem, and makes the exit status 1.
+ *
+ * Then each engine solves each generator at the sizes given with -z for t seconds
+ * through hungarian(), and the solves per second go to stdout and, with -o, are
+ * appended to a CSV file as label,type,engine,generator,rows,cols,solves,seconds,
+ * solves_per_sec, so runs of different commits can be compared. */
+
+#include "hungarian.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Munkres::Matrix;
+using Munkres::Solution;
+
+struct Options {
+    std::size_t rounds = 200;
+    std::uint64_t seed = 1;
+    std::size_t max_size = 40;
+    std::vector<std::size_t> sizes {8, 16, 64, 256};
+    double seconds = 0.2;
+    std::string output;
+    std::string label = "run";
+};
+
+void usage()
+{
+    std::cerr << "usage: hungarian_stress [-r rounds] [-s seed] [-n max_size] [-z 8,64,256] "
+              << "[-t seconds] [-o results.csv] [-l label]\n";
+    std::exit(2);
+}
+
+Options parse(int argc, char* argv[])
+{
+    Options opt;
+
+    for (int i=1; i<argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "-r" && has_value) {
+            opt.rounds = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "-s" && has_value) {
+            opt.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "-n" && has_value) {
+            opt.max_size = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "-z" && has_value) {
+            opt.sizes.clear();
+            std::stringstream list (argv[++i]);
+            std::string size;
+            while (std::getline(list, size, ','))
+                if (std::strtoul(size.c_str(), nullptr, 10) > 0)
+                    opt.sizes.push_back(std::strtoul(size.c_str(), nullptr, 10));
+        }
+        else if (arg == "-t" && has_value) {
+            opt.seconds = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "-o" && has_value) {
+            opt.output = argv[++i];
+        }
+        else if (arg == "-l" && has_value) {
+            opt.label = argv[++i];
+        }
+        else {
+            usage();
+        }
+    }
+
+    return opt;
+}
+
+enum Generator {
+    Uniform,     // independent costs, half of them negative
+    Ties,        // costs in 0..2, every row has many optimal cols
+    SingleValue, // one cost everywhere, every assignment is optimal
+    MacholWien,  // C(i,j) = i*j, the classic worst case of the Hungarian method
+    Huge,        // magnitudes close to what the engines accept
+    Forbidden,   // a third of the pairs forbidden, some problems infeasible
+    Extreme,     // the whole range of the type, up to +-1e9 (4e9 unsigned), crowding its ends,
+                 // or a quarter of the time all at its top, so every offset is that large
+    Generators
+};
+
+const char* generator_names[] = {"uniform", "ties", "single", "machol-wien", "huge", "forbidden", "extreme"};
+
+/* Range of the costs generated as T: all of a narrow type but its forbidden value,
+ * else +-1e9, or 0..4e9 for unsigned types, past INT_MAX.  Doubles take the int range. */
+template<typename T>
+using limits = std::numeric_limits<typename std::conditional<std::is_floating_point<T>::value, int, T>::type>;
+
+template<typename T>
+long long lowest_cost()
+{
+    return std::max<long long>(limits<T>::min(), -1000000000);
+}
+
+template<typename T>
+long long highest_cost()
+{
+    return std::min<long long>(limits<T>::max() - 1, std::is_unsigned<T>::value ? 4000000000 : 1000000000);
+}
+
+template<typename T>
+long long clamp_cost(long long value)
+{
+    return std::min(std::max(value, lowest_cost<T>()), highest_cost<T>());
+}
+
+template<typename T>
+Matrix<T> generate(Generator gen, std::size_t rows, std::size_t cols, std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<long long> small (-500, 500);
+    std::uniform_int_distribution<long long> huge (-100000000, 100000000);
+    std::uniform_int_distribution<int> tie (0, 2);
+    std::uniform_int_distribution<int> third (0, 2);
+    std::uniform_real_distribution<double> frac (0.0, 1.0);
+    std::uniform_int_distribution<long long> full (lowest_cost<T>(), highest_cost<T>());
+    std::uniform_int_distribution<long long> end (0, (highest_cost<T>() - lowest_cost<T>()) / 100);
+    bool real = std::is_floating_point<T>::value;
+    bool top = rng() % 4 == 0;
+
+    Matrix<T> costs (rows, cols);
+    for (std::size_t r=0; r<rows; ++r)
+        for (std::size_t c=0; c<cols; ++c) {
+            T& cell = costs[r][c];
+            switch (gen) {
+                case Uniform:
+                    cell = static_cast<T>(clamp_cost<T>(small(rng)) + (real ? frac(rng) : 0));
+                    break;
+                case Ties:
+                    cell = static_cast<T>(tie(rng));
+                    break;
+                case SingleValue:
+                    cell = T(7);
+                    break;
+                case MacholWien:
+                    cell = static_cast<T>(clamp_cost<T>((r + 1) * (c + 1)));
+                    break;
+                case Huge:
+                    cell = static_cast<T>(clamp_cost<T>(huge(rng)) * (real ? 10000.0 : 1.0));
+                    break;
+                case Forbidden:
+                    cell = third(rng) == 0 ? Munkres::forbidden<T>() : static_cast<T>(clamp_cost<T>(small(rng)));
+                    break;
+                case Extreme:
+                    switch (top ? 1 : third(rng)) {
+                        case 0: cell = static_cast<T>(lowest_cost<T>() + end(rng)); break;
+                        case 1: cell = static_cast<T>(highest_cost<T>() - end(rng)); break;
+                        default: cell = static_cast<T>(full(rng)); break;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+    return costs;
+}
+
+/* What an engine made of a problem: its solution, or that it found none */
+template<typename T>
+struct Outcome {
+    bool feasible = false;
+    Solution<T> solution;
+};
+
+/* The fixed size solver for square problems of 1..16 */
+template<typename T, std::size_t N>
+bool solve_fixed(const Matrix<T>&, Solution<T>&, std::integral_constant<std::size_t, N>, std::true_type)
+{
+    return false;
+}
+
+template<typename T, std::size_t N>
+bool solve_fixed(const Matrix<T>& costs, Solution<T>& out, std::integral_constant<std::size_t, N>, std::false_type)
+{
+    if (costs.rows() != N)
+        return solve_fixed(costs, out, std::integral_constant<std::size_t, N+1>(),
+                           std::integral_constant<bool, (N+1 > 16)>());
+
+    std::array<std::array<T, N>, N> fixed;
+    for (std::size_t r=0; r<N; ++r)
+        std::copy(costs[r], costs[r] + N, fixed[r].begin());
+    auto res = Munkres::hungarian(fixed);
+    out.assignment.assign(res.assignment.begin(), res.assignment.end());
+    out.cost = res.cost;
+    return true;
+}
+
+template<typename T>
+Munkres::SparseMatrix<T> sparse(const Matrix<T>& costs)
+{
+    Munkres::SparseMatrix<T> res (costs.cols());
+    for (std::size_t r=0; r<costs.rows(); ++r) {
+        for (std::size_t c=0; c<costs.cols(); ++c)
+            if (!Munkres::is_forbidden(costs[r][c]))
+                res.add(c, costs[r][c]);
+        res.end_row();
+    }
+    return res;
+}
+
+enum Engine {
+    MunkresSteps,
+    ShortestPath,
+    Auction,
+    Sparse,
+    Fixed,
+    PooledMunkres,      // the dense engines given a ThreadPool
+    PooledShortestPath,
+    PooledAuction,
+    Service,            // Munkres on a SolveService worker
+    Engines
+};
+
+const char* engine_names[] = {"munkres", "jv", "auction", "sparse", "fixed",
+                              "munkres-pool", "jv-pool", "auction-pool", "service"};
+
+/* The pool of the pooled engines and the service, shared by all the solves of a type.
+ * Below serial_threshold cells of work the pool runs a loop on the calling thread. */
+template<typename T>
+struct Runners {
+    Munkres::ThreadPool pool;
+    Munkres::SolveService<T> service;
+
+    explicit Runners(std::size_t serial_threshold)
+        : pool (4, serial_threshold), service (2) {}
+};
+
+/* Solve with one engine, false if it does not take problems of this shape.  The 
+ * sparse engine reads the same problem built once by sparse(). */
+template<typename T>
+bool run(Engine engine, const Matrix<T>& costs, const Munkres::SparseMatrix<T>& edges, 
+         Runners<T>& with, Outcome<T>& out)
+{
+    if (engine == Fixed && (costs.rows() != costs.cols() || costs.rows() > 16))
+        return false;
+
+    try {
+        switch (engine) {
+            case MunkresSteps:
+                out.solution = Munkres::hungarian(costs, true, Munkres::Algorithm::Munkres);
+                break;
+            case ShortestPath:
+                out.solution = Munkres::hungarian(costs, true, Munkres::Algorithm::JonkerVolgenant);
+                break;
+            case Auction:
+                out.solution = Munkres::hungarian(costs, true, Munkres::Algorithm::Auction);
+                break;
+            case Sparse:
+                out.solution = Munkres::hungarian(edges);
+                break;
+            case Fixed:
+                solve_fixed(costs, out.solution, std::integral_constant<std::size_t, 1>(), std::false_type());
+                break;
+            case PooledMunkres:
+                out.solution = Munkres::hungarian(costs, true, Munkres::Algorithm::Munkres, &with.pool);
+                break;
+            case PooledShortestPath:
+                out.solution = Munkres::hungarian(costs, true, Munkres::Algorithm::JonkerVolgenant, &with.pool);
+                break;
+            case PooledAuction:
+                out.solution = Munkres::hungarian(costs, true, Munkres::Algorithm::Auction, &with.pool);
+                break;
+            case Service:
+                out.solution = with.service.submit(costs).result.get();
+                break;
+            default:
+                return false;
+        }
+        out.feasible = true;
+    }
+    catch (std::runtime_error&) {
+        out.feasible = false;
+    }
+    return true;
+}
+
+/* Exhaustive search over col subsets: best[mask] is the cheapest way to give the
+ * first popcount(mask) rows the cols of mask, rows <= cols <= 12 after transposing */
+template<typename T>
+Outcome<T> exhaustive(const Matrix<T>& original)
+{
+    bool transposed = original.rows() > original.cols();
+    std::size_t rows = std::min(original.rows(), original.cols());
+    std::size_t cols = std::max(original.rows(), original.cols());
+    auto cost = [&](std::size_t r, std::size_t c) {return transposed ? original[c][r] : original[r][c];};
+
+    using A = typename Munkres::accumulator<T>::type;
+    const A none = std::numeric_limits<A>::max();
+    std::vector<A> best (std::size_t(1) << cols, none);
+    std::vector<int> from (best.size(), -1);
+    best[0] = 0;
+
+    A total = none;
+    std::size_t last = 0;
+    for (std::size_t mask=0; mask<best.size(); ++mask) {
+        if (best[mask] == none)
+            continue;
+        std::size_t r = Munkres::popcount64(mask);
+        if (r == rows) {
+            if (best[mask] < total) {
+                total = best[mask];
+                last = mask;
+            }
+            continue;
+        }
+        for (std::size_t c=0; c<cols; ++c)
+            if (!(mask >> c & 1) && !Munkres::is_forbidden(cost(r, c))) {
+                std::size_t next = mask | std::size_t(1) << c;
+                A val = best[mask] + cost(r, c);
+                if (best[next] == none || val < best[next]) {
+                    best[next] = val;
+                    from[next] = c;
+                }
+            }
+    }
+
+    Outcome<T> out;
+    out.feasible = total != none;
+    if (!out.feasible)
+        return out;
+
+    out.solution.cost = total;
+    out.solution.assignment.assign(original.rows(), -1);
+    for (std::size_t mask=last, r=rows; r-- > 0; ) {
+        int c = from[mask];
+        if (transposed)
+            out.solution.assignment[c] = r;
+        else
+            out.solution.assignment[r] = c;
+        mask &= ~(std::size_t(1) << c);
+    }
+    return out;
+}
+
+/* Slack allowed between two costs: none for integers, the auction and the float
+ * rounding of a sum for doubles */
+template<typename T>
+double slack(const Matrix<T>& costs, double reference)
+{
+    if (!std::is_floating_point<T>::value)
+        return 0;
+    double largest = 0;
+    for (std::size_t r=0; r<costs.rows(); ++r)
+        for (std::size_t c=0; c<costs.cols(); ++c)
+            if (!Munkres::is_forbidden(costs[r][c]))
+                largest = std::max(largest, std::abs(double(costs[r][c])));
+    return 1e-6 * std::max(largest, std::abs(reference));
+}
+
+/* Empty if the solution is a valid assignment with the cost it claims, else why not */
+template<typename T>
+std::string check(const Matrix<T>& costs, const Solution<T>& solution)
+{
+    if (solution.assignment.size() != costs.rows())
+        return "assignment has the wrong length";
+
+    std::vector<char> taken (costs.cols(), 0);
+    std::size_t assigned = 0;
+    double sum = 0;
+    for (std::size_t r=0; r<costs.rows(); ++r) {
+        int c = solution.assignment[r];
+        if (c == -1)
+            continue;
+        if (c < 0 || c >= static_cast<int>(costs.cols()) || taken[c]++)
+            return "row " + std::to_string(r) + " has an invalid or shared col";
+        if (Munkres::is_forbidden(costs[r][c]))
+            return "row " + std::to_string(r) + " took a forbidden pair";
+        sum += double(costs[r][c]);
+        ++assigned;
+    }
+
+    if (assigned != std::min(costs.rows(), costs.cols()))
+        return "not every row or col is assigned";
+    if (std::abs(sum - double(solution.cost)) > slack(costs, sum))
+        return "the assignment costs " + std::to_string(sum) + ", not the reported cost";
+    return "";
+}
+
+/* The reference solution of a problem, see above */
+template<typename T>
+Outcome<T> reference(const Matrix<T>& costs, const Munkres::SparseMatrix<T>& edges, Runners<T>& with)
+{
+    Outcome<T> out;
+    if (std::max(costs.rows(), costs.cols()) <= 12)
+        out = exhaustive(costs);
+    else
+        run(std::is_floating_point<T>::value ? ShortestPath : Auction, costs, edges, with, out);
+    return out;
+}
+
+/* Empty if an outcome agrees with the reference, else why not */
+template<typename T>
+std::string compare(const Matrix<T>& costs, const Outcome<T>& out, const Outcome<T>& reference)
+{
+    if (out.feasible != reference.feasible)
+        return out.feasible ? "solved an infeasible problem" : "found no assignment";
+    if (!out.feasible)
+        return "";
+    std::string what = check(costs, out.solution);
+    if (what.empty() && std::abs(double(out.solution.cost) - double(reference.solution.cost)) > 
+                        slack(costs, double(reference.solution.cost)))
+        what = "cost " + std::to_string(out.solution.cost) + ", expected " +
+               std::to_string(reference.solution.cost);
+    return what;
+}
+
+/* Empty if an IncrementalSolver of the problem follows three random edits, the costs
+ * of each drawn from the generator of the problem, else why not.  An edit that leaves
+ * no assignment ends the run. */
+template<typename T>
+std::string incremental(Matrix<T> costs, Generator gen, Runners<T>& with, std::mt19937_64& rng)
+{
+    Munkres::IncrementalSolver<T> solver;
+    Outcome<T> out;
+    try {
+        out.solution = solver.solve(costs);
+        out.feasible = true;
+    }
+    catch (std::runtime_error&) {
+        return ""; // the engines already checked that it is infeasible
+    }
+
+    for (int edit=0; edit<3 && out.feasible; ++edit) {
+        Matrix<T> fresh = generate<T>(gen, costs.rows(), costs.cols(), rng);
+        std::size_t r = rng() % costs.rows();
+        std::size_t c = rng() % costs.cols();
+        std::string how;
+        switch (rng() % 3) {
+            case 0: {
+                std::vector<T> row (fresh[r], fresh[r] + costs.cols());
+                std::copy(row.begin(), row.end(), costs[r]);
+                solver.set_row(r, row);
+                how = "set_row(" + std::to_string(r) + ")";
+                break;
+            }
+            case 1: {
+                std::vector<T> col (costs.rows());
+                for (std::size_t i=0; i<costs.rows(); ++i)
+                    col[i] = costs[i][c] = fresh[i][c];
+                solver.set_col(c, col);
+                how = "set_col(" + std::to_string(c) + ")";
+                break;
+            }
+            default:
+                costs[r][c] = fresh[r][c];
+                solver.set_cost(r, c, fresh[r][c]);
+                how = "set_cost(" + std::to_string(r) + ", " + std::to_string(c) + ")";
+                break;
+        }
+
+        try {
+            out.solution = solver.resolve();
+            out.feasible = true;
+        }
+        catch (std::runtime_error&) {
+            out.feasible = false;
+        }
+        std::string what = compare(costs, out, reference(costs, sparse(costs), with));
+        if (!what.empty())
+            return "after " + how + ": " + what;
+    }
+    return "";
+}
+
+/* Costs of every assignment of rows to distinct allowed cols, rows <= cols */
+template<typename T, typename Cost>
+void enumerate(Cost cost, std::size_t r, std::size_t rows, std::size_t cols, std::vector<char>& used,
+               typename Munkres::accumulator<T>::type sum, std::vector<typename Munkres::accumulator<T>::type>& all)
+{
+    if (r == rows) {
+        all.push_back(sum);
+        return;
+    }
+    for (std::size_t c=0; c<cols; ++c)
+        if (!used[c] && !Munkres::is_forbidden(cost(r, c))) {
+            used[c] = 1;
+            enumerate<T>(cost, r + 1, rows, cols, used, sum + cost(r, c), all);
+            used[c] = 0;
+        }
+}
+
+/* Empty if k_best() of the top left corner of at most 6x7 of the problem, on the pool
+ * half of the time, gives its k cheapest assignments with the costs of all of them 
+ * enumerated and sorted, else why not */
+template<typename T>
+std::string ranking(const Matrix<T>& costs, Runners<T>& with, std::mt19937_64& rng)
+{
+    Matrix<T> corner (std::min<std::size_t>(costs.rows(), 6), std::min<std::size_t>(costs.cols(), 7));
+    for (std::size_t r=0; r<corner.rows(); ++r)
+        std::copy(costs[r], costs[r] + corner.cols(), corner[r]);
+
+    bool transposed = corner.rows() > corner.cols();
+    auto cost = [&](std::size_t r, std::size_t c) {return transposed ? corner[c][r] : corner[r][c];};
+    std::vector<typename Munkres::accumulator<T>::type> all;
+    std::vector<char> used (std::max(corner.rows(), corner.cols()), 0);
+    enumerate<T>(cost, 0, std::min(corner.rows(), corner.cols()), used.size(), used, 0, all);
+    std::sort(all.begin(), all.end());
+
+    std::size_t k = 1 + rng() % 12;
+    auto best = Munkres::k_best(corner, k, rng() % 2 ? &with.pool : nullptr);
+    if (best.size() != std::min(k, all.size()))
+        return "k_best(" + std::to_string(k) + ") of a " + std::to_string(corner.rows()) + "x" + 
+               std::to_string(corner.cols()) + " corner found " + std::to_string(best.size()) + 
+               " of " + std::to_string(all.size()) + " assignments";
+
+    double tolerance = slack(corner, all.empty() ? 0 : double(all.back()));
+    for (std::size_t i=0; i<best.size(); ++i) {
+        std::string what = check(corner, best[i]);
+        if (what.empty() && std::abs(double(best[i].cost) - double(all[i])) > tolerance)
+            what = "costs " + std::to_string(best[i].cost) + ", expected " + std::to_string(all[i]);
+        for (std::size_t j=0; j<i && what.empty(); ++j)
+            if (best[j].assignment == best[i].assignment)
+                what = "repeats solution " + std::to_string(j);
+        if (!what.empty())
+            return "k_best solution " + std::to_string(i) + " of the corner " + what;
+    }
+    return "";
+}
+
+/* Empty if a solve under a budget of steps is consistent with the reference, else why
+ * not.  An infeasible problem may throw or come back incomplete. */
+template<typename T>
+std::string bounded(const Matrix<T>& costs, Engine engine, std::uint64_t steps, 
+                    const Outcome<T>& reference, double tolerance, Munkres::BoundedSolution<T>& res)
+{
+    auto algorithm = engine == MunkresSteps ? Munkres::Algorithm::Munkres : Munkres::Algorithm::JonkerVolgenant;
+    try {
+        res = Munkres::hungarian(costs, Munkres::Budget::steps(steps), Munkres::Objective::Minimize, algorithm);
+    }
+    catch (std::runtime_error&) {
+        return reference.feasible ? "found no assignment under a budget" : "";
+    }
+
+    if (!reference.feasible)
+        return res.complete ? "completed an infeasible problem under a budget" : "";
+    if (res.optimal && !res.complete)
+        return "claims an incomplete assignment optimal";
+    if (double(res.bound) > double(reference.solution.cost) + tolerance)
+        return "bound " + std::to_string(res.bound) + " above the optimum " + 
+               std::to_string(reference.solution.cost);
+    if (!res.complete)
+        return "";
+    std::string what = check(costs, res);
+    if (what.empty() && double(res.cost) < double(reference.solution.cost) - tolerance)
+        what = "cost " + std::to_string(res.cost) + " below the optimum " + 
+               std::to_string(reference.solution.cost);
+    return what.empty() ? what : what + " under a budget";
+}
+
+template<typename T>
+void report(const Matrix<T>& costs, const std::string& what, const Options& opt,
+            std::size_t round, Generator gen)
+{
+    std::cerr << "MISMATCH " << what << "\n  seed " << opt.seed << " round " << round
+              << " " << generator_names[gen] << " " << costs.rows() << "x" << costs.cols() << "\n";
+    if (costs.rows() * costs.cols() <= 256)
+        std::cerr << costs;
+}
+
+template<typename T>
+std::size_t differential(const Options& opt, const char* type)
+{
+    std::mt19937_64 rng (opt.seed);
+    std::uniform_int_distribution<std::size_t> side (1, opt.max_size);
+    std::size_t failures = 0;
+    std::size_t solved = 0;
+    Runners<T> with (64);
+
+    for (std::size_t round=0; round<opt.rounds; ++round)
+        for (int g=0; g<Generators; ++g) {
+            auto gen = static_cast<Generator>(g);
+            std::size_t rows = side(rng);
+            std::size_t cols = rng() % 4 == 0 ? rows : side(rng);
+            if (rng() % 4 == 0)
+                rows = cols = std::min<std::size_t>(rows, 16); // the fixed size solver's range
+            Matrix<T> costs = generate<T>(gen, rows, cols, rng);
+            auto edges = sparse(costs);
+
+            Outcome<T> expected = reference(costs, edges, with);
+            double tolerance = slack(costs, double(expected.solution.cost));
+
+            for (int e=0; e<Engines; ++e) {
+                Outcome<T> out;
+                if (!run(static_cast<Engine>(e), costs, edges, with, out))
+                    continue;
+                ++solved;
+
+                std::string what = compare(costs, out, expected);
+                if (!what.empty()) {
+                    report(costs, std::string(type) + " " + engine_names[e] + ": " + what, opt, round, gen);
+                    ++failures;
+                }
+            }
+
+            std::string what = incremental(costs, gen, with, rng);
+            if (!what.empty()) {
+                report(costs, std::string(type) + " incremental: " + what, opt, round, gen);
+                ++failures;
+            }
+            what = ranking(costs, with, rng);
+            if (!what.empty()) {
+                report(costs, std::string(type) + " " + what, opt, round, gen);
+                ++failures;
+            }
+            solved += 2;
+
+            // half of the time there is no budget left past the initial assignment
+            std::uint64_t steps = rng() % 2 ? 0 : rng() % (rows + 1);
+            Munkres::BoundedSolution<T> early[2];
+            for (auto e: {MunkresSteps, ShortestPath}) {
+                what = bounded(costs, e, steps, expected, tolerance, early[e]);
+                ++solved;
+                if (!what.empty()) {
+                    report(costs, std::string(type) + " " + engine_names[e] + ": " + what, opt, round, gen);
+                    ++failures;
+                }
+            }
+            if (steps == 0 && rows == cols && expected.feasible &&
+                std::abs(double(early[0].bound) - double(early[1].bound)) > tolerance) {
+                report(costs, std::string(type) + " munkres: bound " + std::to_string(early[0].bound) + 
+                       " with no steps, jv " + std::to_string(early[1].bound), opt, round, gen);
+                ++failures;
+            }
+        }
+
+    std::cout << type << ": " << solved << " solves checked, " << failures << " mismatches\n";
+    return failures;
+}
+
+template<typename T>
+void throughput(const Options& opt, const char* type, std::ostream* csv)
+{
+    using Clock = std::chrono::steady_clock;
+    std::mt19937_64 rng (opt.seed);
+    Runners<T> with (1 << 15);
+
+    for (auto size: opt.sizes)
+        for (int g=0; g<Generators; ++g) {
+            auto gen = static_cast<Generator>(g);
+            Matrix<T> costs = generate<T>(gen, size, size, rng);
+            auto edges = sparse(costs);
+
+            for (int e=0; e<Engines; ++e) {
+                Outcome<T> out;
+                std::size_t solves = 0;
+                auto start = Clock::now();
+                double elapsed = 0;
+                // at least one solve, then until the time slice is used up
+                do {
+                    if (!run(static_cast<Engine>(e), costs, edges, with, out))
+                        break;
+                    ++solves;
+                    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+                } while (elapsed < opt.seconds);
+                if (solves == 0)
+                    continue;
+
+                double rate = solves / elapsed;
+                std::cout << type << " " << engine_names[e] << " " << generator_names[g] << " "
+                          << size << "x" << size << ": " << rate << " solves/s\n";
+                if (csv)
+                    *csv << opt.label << "," << type << "," << engine_names[e] << ","
+                         << generator_names[g] << "," << size << "," << size << ","
+                         << solves << "," << elapsed << "," << rate << "\n";
+            }
+        }
+}
+
+int main(int argc, char* argv[])
+{
+    Options opt = parse(argc, argv);
+
+    std::size_t failures = differential<std::int8_t>(opt, "int8") + differential<std::int16_t>(opt, "int16")
+                         + differential<int>(opt, "int") + differential<std::uint32_t>(opt, "uint32")
+                         + differential<double>(opt, "double");
+
+    std::ofstream csv;
+    if (!opt.output.empty()) {
+        bool fresh = !std::ifstream(opt.output).good();
+        csv.open(opt.output, std::ios::app);
+        if (!csv) {
+            std::cerr << argv[0] << ": cannot open " << opt.output << "\n";
+            return 1;
+        }
+        if (fresh)
+            csv << "label,type,engine,generator,rows,cols,solves,seconds,solves_per_sec\n";
+    }
+
+    if (opt.seconds > 0) {
+        throughput<int>(opt, "int", csv.is_open() ? &csv : nullptr);
+        throughput<double>(opt, "double", csv.is_open() ? &csv : nullptr);
+    }
+
+    return failures == 0 ? 0 : 1;
+}